@@ -81,6 +81,25 @@ uint32_t __Arch_APICall_2(uint32_t call, uint32_t a, uint32_t b)
         case OUTADDRL:
             callptr = outaddrl;
             break;
+        case SMPREQUEST:
+            callptr = smpRequest;
+            break;
+        case IRQROUTE:
+#ifdef VARIANT_GALILEO
+            /* No irqRoute callgate on the galileo kernel, 0xE0 is a TSS there */
+            return 0;
+#else
+            callptr = irqRoute;
+            break;
+#endif
+        case IOBATCH:
+#ifdef VARIANT_GALILEO
+            /* No ioBatch callgate on the galileo kernel */
+            callptr = ioBatchSingle;
+#else
+            callptr = ioBatch;
+#endif
+            break;
         default:
             return 0;
     }
@@ -89,7 +108,28 @@ uint32_t __Arch_APICall_2(uint32_t call, uint32_t a, uint32_t b)
 }
 uint32_t __Arch_APICall_3(uint32_t call, uint32_t a, uint32_t b, uint32_t c)
 {
-    return 0;
+    apicall_3 callptr;
+    switch(call)
+    {
+        case REMOVEVADDRRANGE:
+            callptr = unmapRange;
+            break;
+        case TRACEDRAIN:
+            callptr = traceDrain;
+            break;
+        case IOGRANT:
+#ifdef VARIANT_GALILEO
+            /* No ioGrant callgate on the galileo kernel, 0xF0 is a TSS there */
+            return 0;
+#else
+            callptr = ioGrant;
+            break;
+#endif
+        default:
+            return 0;
+    }
+
+    return callptr(a, b, c);
 }
 uint32_t __Arch_APICall_4(uint32_t call, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
 {
@@ -116,6 +156,9 @@ uint32_t __Arch_APICall_5(uint32_t call, uint32_t a, uint32_t b, uint32_t c, uin
         case DISPATCH:
             callptr = dispatch;
             break;
+        case ADDVADDRRANGE:
+            callptr = mapRange;
+            break;
         default:
             return 0;
     }
@@ -24,6 +24,13 @@ uint32_t __Arch_APICall_6(uint32_t call, uint32_t a, uint32_t b, uint32_t c, uin
 #define OUTL                (ARCH_DEPENDANT + 4)
 #define INL                 (ARCH_DEPENDANT + 5)
 #define OUTADDRL            (ARCH_DEPENDANT + 6)
+#define ADDVADDRRANGE       (ARCH_DEPENDANT + 7)
+#define REMOVEVADDRRANGE    (ARCH_DEPENDANT + 8)
+#define TRACEDRAIN          (ARCH_DEPENDANT + 9)
+#define SMPREQUEST          (ARCH_DEPENDANT + 10)
+#define IRQROUTE            (ARCH_DEPENDANT + 11)
+#define IOBATCH             (ARCH_DEPENDANT + 12)
+#define IOGRANT             (ARCH_DEPENDANT + 13)
 
 /* Extra pipcalls for x86 declaration */
 #define Pip_Outb(a, b)         __Arch_APICall(OUTB, 2, a, b)
@@ -34,4 +41,66 @@ uint32_t __Arch_APICall_6(uint32_t call, uint32_t a, uint32_t b, uint32_t c, uin
 #define Pip_Inl(a)             __Arch_APICall(INL, 1, a)
 #define Pip_Outaddrl(a, b)     __Arch_APICall(OUTADDRL, 2, a, b)
 
+/* Range variants of AddVAddr/RemoveVAddr, one kernel entry for count pages */
+#define Pip_AddVAddrRange(a, b, c, d, e)   __Arch_APICall(ADDVADDRRANGE, 5, a, b, c, d, e)
+#define Pip_RemoveVAddrRange(a, b, c)      __Arch_APICall(REMOVEVADDRRANGE, 3, a, b, c)
+
+/* Copies up to c records of core a's kernel trace ring to b, root partition only */
+#define Pip_TraceDrain(a, b, c)            __Arch_APICall(TRACEDRAIN, 3, a, (uint32_t)(b), c)
+
+/* SMP requests, read-only queries about the kernel */
+#define PIP_SMP_COREID          0
+#define PIP_SMP_CORECOUNT       1
+#define PIP_SMP_LOCKTAKEN       2
+#define PIP_SMP_LOCKSPUN        3
+#define PIP_SMP_PIPCALLSTAT     4 /* Root partition only */
+#define PIP_SMP_TIMEPAGE        5 /* Address of the read-only time page */
+#define PIP_SMP_MAPPED          6 /* 1 if the page holding the address is mapped writable in the caller */
+#define Pip_SmpRequest(a, b)               __Arch_APICall(SMPREQUEST, 2, a, b)
+
+/* Pipcall statistics of a core : count of call c, or its log2 cycles histogram bucket b */
+#define PIP_PIPSTAT_BUCKETS     32
+#define Pip_PipcallCount(core, c)          Pip_SmpRequest(PIP_SMP_PIPCALLSTAT, ((core) << 16) | ((c) << 8) | 0xFF)
+#define Pip_PipcallBucket(core, c, b)      Pip_SmpRequest(PIP_SMP_PIPCALLSTAT, ((core) << 16) | ((c) << 8) | (b))
+
+/* Hands IRQ line a (0-15) to child b, or back to the root partition if b is 0.
+ * The child then gets VINT 33+a directly, latched while it is VCLI'd.
+ * Always fails with 0 on the galileo variant */
+#define Pip_IrqRoute(a, b)                 __Arch_APICall(IRQROUTE, 2, a, b)
+
+/* Runs b IO accesses described by the Pip_IoOp array a in one kernel entry,
+ * reads are returned in place. Returns the number of accesses run */
+#define PIP_IO_OUTB             0
+#define PIP_IO_OUTW             1
+#define PIP_IO_OUTL             2
+#define PIP_IO_INB              3
+#define PIP_IO_INW              4
+#define PIP_IO_INL              5
+#define PIP_IO_OUTSB            6 /* value is a buffer address, count its element count */
+#define PIP_IO_OUTSW            7
+#define PIP_IO_OUTSL            8
+#define PIP_IO_INSB             9
+#define PIP_IO_INSW             10
+#define PIP_IO_INSL             11
+#define PIP_IO_BATCH_MAX        256
+
+typedef struct Pip_IoOp_s {
+    uint32_t op;        /* PIP_IO_* */
+    uint32_t port;
+    uint32_t value;     /* Written value, read value or buffer address */
+    uint32_t count;     /* String operations only */
+} Pip_IoOp;
+
+#define Pip_IoBatch(a, b)                  __Arch_APICall(IOBATCH, 2, (uint32_t)(a), b)
+
+/* Lets child a run in/out natively on the c ports from b, which the caller has
+ * to hold itself. c = 0 revokes every port of the child and its descendants.
+ * Always fails with 0 on the galileo variant */
+#define Pip_IoGrant(a, b, c)               __Arch_APICall(IOGRANT, 3, a, b, c)
+
+/* Time since boot read from the TSC and the time page, without a kernel entry
+ * but the first one. Pip_TscKhz gives the TSC frequency to convert it */
+uint64_t Pip_Now64(void);
+uint32_t Pip_TscKhz(void);
+
 #endif
@@ -25,6 +25,17 @@ extern uint32_t createPartition(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t
 
 extern uint32_t mapPage(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t); 
 
+extern uint32_t mapRange(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+extern uint32_t unmapRange(uint32_t, uint32_t, uint32_t);
+extern uint32_t traceDrain(uint32_t, uint32_t, uint32_t);
+extern uint32_t smpRequest(uint32_t, uint32_t);
+extern uint32_t irqRoute(uint32_t, uint32_t);
+extern uint32_t ioBatch(uint32_t, uint32_t);
+#ifdef VARIANT_GALILEO
+extern uint32_t ioBatchSingle(uint32_t, uint32_t);
+#endif
+extern uint32_t ioGrant(uint32_t, uint32_t, uint32_t);
+
 /* IO ports calls - x86 */
 extern uint32_t inb(uint32_t);
 extern uint32_t inw(uint32_t);
@@ -0,0 +1,15 @@
+#ifndef __TIME_X86__
+#define __TIME_X86__
+
+#include <stdint.h>
+
+/* Read-only time page, found through Pip_SmpRequest(PIP_SMP_TIMEPAGE) - mirrors the kernel's timepage.h */
+#define PIP_TIMEPAGE_MAGIC      0x54494D45 /* "TIME" */
+
+typedef struct Pip_TimePage_s {
+    uint32_t magic;         /* PIP_TIMEPAGE_MAGIC once the page is valid */
+    uint32_t tscKhz;        /* TSC frequency, in kHz */
+    uint64_t tscBase;       /* TSC value at boot, shared by every core */
+} __attribute__((packed)) Pip_TimePage;
+
+#endif
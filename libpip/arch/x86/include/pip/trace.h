@@ -0,0 +1,21 @@
+#ifndef __TRACE_X86__
+#define __TRACE_X86__
+
+#include <stdint.h>
+
+/* Kernel trace records, as copied by Pip_TraceDrain - mirrors the kernel's trace.h */
+#define PIP_TRACE_LOST          0 /* args[0] records overwritten before being drained */
+#define PIP_TRACE_INTERRUPT     1 /* int_no, eip, error code */
+#define PIP_TRACE_DISPATCH      2 /* partition, vint, caller, data1 */
+#define PIP_TRACE_IPDISPATCH    3 /* partition, vint, target core, data1 */
+#define PIP_TRACE_RESUME        4 /* descriptor, partition, pipflags */
+
+typedef struct Pip_TraceRecord_s {
+    uint32_t seq;       /* Position in the core's ring, + 1 */
+    uint16_t event;     /* PIP_TRACE_* identifier */
+    uint16_t core;      /* Core that recorded the event */
+    uint64_t tsc;       /* Time stamp counter at record time */
+    uint32_t args[4];   /* Event arguments */
+} Pip_TraceRecord;
+
+#endif
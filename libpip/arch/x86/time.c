@@ -0,0 +1,40 @@
+#include <stdint.h>
+#include "pip/api.h"
+#include "pip/time.h"
+
+/* Found once, the page does not move */
+static const Pip_TimePage* timePage;
+
+static const Pip_TimePage* timePageGet(void)
+{
+    if(!timePage)
+    {
+        const Pip_TimePage* page = (const Pip_TimePage*)Pip_SmpRequest(PIP_SMP_TIMEPAGE, 0);
+        if(page && page->magic == PIP_TIMEPAGE_MAGIC)
+            timePage = page;
+    }
+    return timePage;
+}
+
+static uint64_t rdtsc(void)
+{
+    uint32_t low, high;
+    __asm__ volatile("rdtsc" : "=a"(low), "=d"(high));
+    return ((uint64_t)high << 32) | low;
+}
+
+uint64_t Pip_Now64(void)
+{
+    const Pip_TimePage* page = timePageGet();
+    if(!page)
+        return 0;
+
+    /* The page is written once at boot, before any partition runs */
+    return rdtsc() - page->tscBase;
+}
+
+uint32_t Pip_TscKhz(void)
+{
+    const Pip_TimePage* page = timePageGet();
+    return page ? page->tscKhz : 0;
+}
@@ -1,9 +1,12 @@
 #include <pip/api.h>
+#include <pip/debug.h>
 
 #define SERIAL_PORT 0x3f8
 
 void Pip_Debug_Putc(char c)
 {
+    if (Pip_Debug_ConsolePutc(c))
+        return;
     while (!(Pip_Inb(SERIAL_PORT + 5) & 0x20));
     Pip_Outb(SERIAL_PORT, c);
 }
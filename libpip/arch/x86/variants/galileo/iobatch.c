@@ -0,0 +1,106 @@
+/*******************************************************************************/
+/*  © Université Lille 1, The Pip Development Team (2015-2017)                 */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/**
+ * \file iobatch.c
+ * \brief Pip_IoBatch on the galileo kernel, one callgate per access
+ *
+ * The galileo kernel has no ioBatch callgate : selector 0xE8 is a TSS there.
+ * Batches are run here instead, through the single-port callgates, so that
+ * drivers can use Pip_IoBatch on every target.
+ */
+#include <stdint.h>
+#include "pip/api.h"
+#include "pip/calltable.h"
+
+uint32_t ioBatchSingle(uint32_t ops, uint32_t count)
+{
+	Pip_IoOp *o = (Pip_IoOp*)ops;
+	uint32_t i, n;
+
+	if(count > PIP_IO_BATCH_MAX)
+		return 0;
+
+	for(i = 0; i < count; i++, o++)
+	{
+		switch(o->op)
+		{
+			case PIP_IO_OUTB:
+				outb(o->port, o->value);
+				break;
+			case PIP_IO_OUTW:
+				outw(o->port, o->value);
+				break;
+			case PIP_IO_OUTL:
+				outl(o->port, o->value);
+				break;
+			case PIP_IO_INB:
+				o->value = inb(o->port);
+				break;
+			case PIP_IO_INW:
+				o->value = inw(o->port);
+				break;
+			case PIP_IO_INL:
+				o->value = inl(o->port);
+				break;
+			case PIP_IO_OUTSB:
+				for(n = 0; n < o->count; n++)
+					outb(o->port, ((uint8_t*)o->value)[n]);
+				break;
+			case PIP_IO_OUTSW:
+				for(n = 0; n < o->count; n++)
+					outw(o->port, ((uint16_t*)o->value)[n]);
+				break;
+			case PIP_IO_OUTSL:
+				for(n = 0; n < o->count; n++)
+					outl(o->port, ((uint32_t*)o->value)[n]);
+				break;
+			case PIP_IO_INSB:
+				for(n = 0; n < o->count; n++)
+					((uint8_t*)o->value)[n] = inb(o->port);
+				break;
+			case PIP_IO_INSW:
+				for(n = 0; n < o->count; n++)
+					((uint16_t*)o->value)[n] = inw(o->port);
+				break;
+			case PIP_IO_INSL:
+				for(n = 0; n < o->count; n++)
+					((uint32_t*)o->value)[n] = inl(o->port);
+				break;
+			default:
+				return i;
+		}
+	}
+
+	return i;
+}
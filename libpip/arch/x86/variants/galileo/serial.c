@@ -1,4 +1,5 @@
 #include <pip/api.h>
+#include <pip/debug.h>
 #include "galileo-support.h"
 #define SERIAL_PORT 0x3f8
 
@@ -6,6 +7,8 @@
 
 void Pip_Debug_Putc(char c)
 {
+    if (Pip_Debug_ConsolePutc(c))
+        return;
     initGalileoSerial(DEBUG_SERIAL);
     galileoSerialPrintc(c);
 }
@@ -18,9 +18,18 @@
 #define Pip_DeletePartition(a)              __Arch_APICall(DELETEPARTITION, 1, a)
 #define Pip_Collect(a)                      __Arch_APICall(COLLECT, 1, a)
 
+/* Rights of the range calls */
+#define PIP_MAP_READ                        0x1
+#define PIP_MAP_WRITE                       0x2
+#define PIP_MAP_EXEC                        0x4
+#define PIP_MAP_RWX                         (PIP_MAP_READ | PIP_MAP_WRITE | PIP_MAP_EXEC)
+
 /* Wrappers */
 uint32_t Pip_MapPageWrapper(uint32_t source, uint32_t partition, uint32_t destination);
 uint32_t Pip_MapPageWrapper_RONLY(uint32_t source, uint32_t partition, uint32_t destination);
+uint32_t Pip_MapRange(uint32_t source, uint32_t partition, uint32_t destination, uint32_t count, uint32_t rights);
+uint32_t Pip_MapPagesWrapper(void* pages, uint32_t partition, uint32_t destination, uint32_t count);
+uint32_t Pip_UnmapRange(uint32_t partition, uint32_t destination, uint32_t count);
 uint32_t Pip_Notify(uint32_t destination, uint32_t int_no, uint32_t data1, uint32_t data2);
 
 #endif
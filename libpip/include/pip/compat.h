@@ -29,7 +29,12 @@
 #define initPaging                          Pip_InitPaging
 #define allocPage                           Pip_AllocPage
 #define freePage                            Pip_FreePage
+#define allocPages                          Pip_AllocPages
+#define freePages                           Pip_FreePages
 #define mapPageWrapper                      Pip_MapPageWrapper
+#define mapPagesWrapper                     Pip_MapPagesWrapper
+#define mapRange                            Pip_MapRange
+#define unmapRange                          Pip_UnmapRange
 
 /* Debug output */
 #define puts                                Pip_Debug_Puts
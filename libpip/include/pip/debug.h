@@ -1,6 +1,25 @@
 #ifndef DEF_DEBUG_H
 #define DEF_DEBUG_H
 
+#include <stdint.h>
+
+/* Console page a child partition prints into instead of the UART, the parent
+ * drains it to the UART when the child leaves the CPU. The child writes head,
+ * the parent writes tail, characters past a full ring are only counted */
+#define PIP_CONSOLE_MAGIC   0x434F4E53 /* "CONS" */
+#define PIP_CONSOLE_SIZE    2048
+
+typedef struct Pip_Console_s {
+    uint32_t magic;
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    volatile uint32_t lost;
+    char data[PIP_CONSOLE_SIZE];
+} Pip_Console;
+
+void Pip_Debug_SetConsole(Pip_Console* console);
+int Pip_Debug_ConsolePutc(char c);
+
 void Pip_Debug_Putc(char c);
 void Pip_Debug_Puts(char *msg);
 void Pip_Debug_PutDec(unsigned long n);
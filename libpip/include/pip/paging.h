@@ -8,6 +8,15 @@
 
 int Pip_InitPaging(void* begin, void* end);
 void* Pip_AllocPage(void);
+void* Pip_AllocPageRaw(void);
 void Pip_FreePage(void* page);
 
+/* Page chains are linked through the first word of each page, NULL ended,
+ * which is also the layout Pip_Prepare expects */
+#define Pip_NextPage(page) (*(void**)(page))
+
+void* Pip_AllocPages(uint32_t count);
+void* Pip_AllocPagesRaw(uint32_t count);
+void Pip_FreePages(void* pages);
+
 #endif
@@ -1,4 +1,37 @@
 #include "pip/debug.h"
+#include "pip/api.h"
+
+static Pip_Console* debugConsole;
+
+/* The parent may not have mapped the page at all : ask the kernel before
+ * touching it, the UART is used otherwise */
+void Pip_Debug_SetConsole(Pip_Console* console)
+{
+    debugConsole = (console
+                    && Pip_SmpRequest(PIP_SMP_MAPPED, (uint32_t)console)
+                    && Pip_SmpRequest(PIP_SMP_MAPPED, (uint32_t)console + sizeof(Pip_Console) - 1)
+                    && console->magic == PIP_CONSOLE_MAGIC) ? console : 0;
+}
+
+/* Returns 0 when there is no console page, the caller then uses the UART */
+int Pip_Debug_ConsolePutc(char c)
+{
+    uint32_t head;
+
+    if (!debugConsole)
+        return 0;
+
+    head = debugConsole->head;
+    if (head - debugConsole->tail >= PIP_CONSOLE_SIZE) {
+        debugConsole->lost++;
+        return 1;
+    }
+    debugConsole->data[head & (PIP_CONSOLE_SIZE - 1)] = c;
+    /* The character must be stored before the parent sees the new head */
+    __asm__ volatile("" ::: "memory");
+    debugConsole->head = head + 1;
+    return 1;
+}
 
 void Pip_Debug_Puts(char *msg)
 {
@@ -36,21 +36,78 @@ int Pip_InitPaging(void *begin, void *end)
 	return 0;
 }
 
+/* Zeroes a page a word at a time */
+static void Pip_ZeroPage(void* page)
+{
+#if defined(__i386__)
+	uint32_t edi, ecx;
+	__asm__ volatile("cld\n\trep stosl"
+			: "=&D"(edi), "=&c"(ecx)
+			: "0"(page), "1"(PGSIZE / sizeof(uint32_t)), "a"(0)
+			: "memory");
+#else
+	uint32_t j;
+	for(j=0;j<PGSIZE/sizeof(uint32_t);j++)
+		((uint32_t*)page)[j] = 0;
+#endif
+}
+
+/* Unlinks count pages from the free list, leaving them chained through their
+ * first word. The list is left untouched if there are not enough pages. */
+static void* Pip_TakePages(uint32_t count)
+{
+	void *first = Pager_FirstFreePage, *last = first;
+	uint32_t i;
+
+	if(!count || !first)
+		return NULL;
+
+	for(i = 1; i < count; i++){
+		last = Pip_NextPage(last);
+		if(!last)
+			return NULL;
+	}
+
+	Pager_FirstFreePage = Pip_NextPage(last);
+	Pip_NextPage(last) = NULL;
+
+	return first;
+}
+
 /* Allocates a page */
 void* Pip_AllocPage(void)
 {
-    void* ret = Pager_FirstFreePage;
-		if(!ret)
-			return 0;
+	void* ret = Pip_TakePages(1);
+	if(ret)
+		Pip_ZeroPage(ret);
 
-		Pager_FirstFreePage = *(void**)ret;
+	return ret;
+}
 
-		
-		int j;
-		for(j=0;j<PGSIZE;j++)
-				((char*)ret)[j] = (char)0;
+/* Allocates a page without clearing it, for pages about to be overwritten */
+void* Pip_AllocPageRaw(void)
+{
+	return Pip_TakePages(1);
+}
 
-    return ret;
+/* Allocates a chain of count zeroed pages, only the link words are set */
+void* Pip_AllocPages(uint32_t count)
+{
+	void *ret = Pip_TakePages(count), *page, *next;
+
+	for(page = ret; page; page = next){
+		next = Pip_NextPage(page);
+		Pip_ZeroPage(page);
+		Pip_NextPage(page) = next;
+	}
+
+	return ret;
+}
+
+/* Allocates a chain of count pages without clearing them */
+void* Pip_AllocPagesRaw(uint32_t count)
+{
+	return Pip_TakePages(count);
 }
 
 /* Frees a page */
@@ -59,3 +116,18 @@ void Pip_FreePage(void* page)
     *(void**)page = Pager_FirstFreePage;
     Pager_FirstFreePage = page;
 }
+
+/* Frees a whole chain of pages */
+void Pip_FreePages(void* pages)
+{
+	void* last = pages;
+
+	if(!pages)
+		return;
+
+	while(Pip_NextPage(last))
+		last = Pip_NextPage(last);
+
+	Pip_NextPage(last) = Pager_FirstFreePage;
+	Pager_FirstFreePage = pages;
+}
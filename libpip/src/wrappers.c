@@ -3,20 +3,21 @@
 #include "pip/paging.h"
 #include "pip/debug.h"
 
-uint32_t Pip_MapPageWrapper(uint32_t source, uint32_t partition, uint32_t destination)
+/* A page table covers 4MB of the child address space */
+#define PTSIZE 0x400000
+
+/* Gives the kernel the indirection tables needed to map destination, if any */
+static uint32_t Pip_PrepareVAddr(uint32_t partition, uint32_t destination)
 {
-	uint32_t i, count, *page, *tmp;
+	uint32_t count, *page;
 
 	if((count = Pip_PageCount((uint32_t)partition, (uint32_t)destination)) > 0)
 	{
-
-		page = Pip_AllocPage();
-		*(void**)page = (void*)0;
-
-		for(i=0; i<count-1; i++){
-			tmp = Pip_AllocPage();
-			*(void**)tmp = page;
-			page = tmp;
+		/* The kernel initializes the indirection tables itself */
+		if(!(page = Pip_AllocPagesRaw(count)))
+		{
+			Pip_Debug_Puts("LibPip2 : Out of pages for prepare. Aborting page map.\r\n");
+			return -1;
 		}
 
 		if (!Pip_Prepare((uint32_t)partition, (uint32_t)(destination), (uint32_t)page, 0x0))
@@ -25,6 +26,15 @@ uint32_t Pip_MapPageWrapper(uint32_t source, uint32_t partition, uint32_t destin
 			return -1;
 		}
 	}
+
+	return 0;
+}
+
+uint32_t Pip_MapPageWrapper(uint32_t source, uint32_t partition, uint32_t destination)
+{
+	if(Pip_PrepareVAddr(partition, destination))
+		return -1;
+
 	if(!Pip_AddVAddr((uint32_t)source, (uint32_t)partition, (uint32_t)destination, 0x1, 0x1, 0x1)){
 		Pip_Debug_Puts("LibPip2 : MapPage operation failed ");
 		Pip_Debug_PutHex(source);
@@ -37,28 +47,36 @@ uint32_t Pip_MapPageWrapper(uint32_t source, uint32_t partition, uint32_t destin
 
 uint32_t Pip_MapPageWrapper_RONLY(uint32_t source, uint32_t partition, uint32_t destination)
 {
-	uint32_t i, count, *page, *tmp;
+	if(Pip_PrepareVAddr(partition, destination))
+		return -1;
 
-	if((count = Pip_PageCount((uint32_t)partition, (uint32_t)destination)) > 0)
-	{
+	if(!Pip_AddVAddr((uint32_t)source, (uint32_t)partition, (uint32_t)destination, 0x1, 0x0, 0x0)){
+		Pip_Debug_Puts("LibPip2 : MapPage operation failed ");
+		Pip_Debug_PutHex(source);
+		Pip_Debug_Puts("\r\n");
+		return -1;
+	}
 
-		page = Pip_AllocPage();
-		*(void**)page = (void*)0;
+	return 0;
+}
 
-		for(i=0; i<count-1; i++){
-			tmp = Pip_AllocPage();
-			*(void**)tmp = page;
-			page = tmp;
-		}
+/* Maps count pages from consecutive source addresses to consecutive
+ * destination addresses, preparing once per page table of the range */
+uint32_t Pip_MapRange(uint32_t source, uint32_t partition, uint32_t destination, uint32_t count, uint32_t rights)
+{
+	uint32_t va, end = destination + count * PGSIZE;
 
-		if (!Pip_Prepare((uint32_t)partition, (uint32_t)(destination), (uint32_t)page, 0x0))
-		{
-			Pip_Debug_Puts("LibPip2 : Prepare operation failed. Aborting page map.\r\n");
+	if(!count)
+		return 0;
+
+	for(va = destination; va < end; va = (va & ~(PTSIZE - 1)) + PTSIZE)
+	{
+		if(Pip_PrepareVAddr(partition, va))
 			return -1;
-		}
 	}
-	if(!Pip_AddVAddr((uint32_t)source, (uint32_t)partition, (uint32_t)destination, 0x1, 0x0, 0x0)){
-		Pip_Debug_Puts("LibPip2 : MapPage operation failed ");
+
+	if(Pip_AddVAddrRange(source, partition, destination, count, rights) != count){
+		Pip_Debug_Puts("LibPip2 : MapRange operation failed ");
 		Pip_Debug_PutHex(source);
 		Pip_Debug_Puts("\r\n");
 		return -1;
@@ -67,6 +85,46 @@ uint32_t Pip_MapPageWrapper_RONLY(uint32_t source, uint32_t partition, uint32_t
 	return 0;
 }
 
+/* Maps the first count pages of a chain at consecutive destination addresses.
+ * Pages that follow each other in memory go in a single range call, and the
+ * link words are cleared so the child gets them blank. */
+uint32_t Pip_MapPagesWrapper(void* pages, uint32_t partition, uint32_t destination, uint32_t count)
+{
+	uint32_t run, i = 0;
+	void *first, *next;
+
+	while(i < count)
+	{
+		if(!pages)
+			return -1;
+
+		first = pages;
+		run = 0;
+		do {
+			next = Pip_NextPage(pages);
+			Pip_NextPage(pages) = 0;
+			pages = next;
+			run++;
+		} while(i + run < count && pages == (void*)((uint32_t)first + run * PGSIZE));
+
+		if(Pip_MapRange((uint32_t)first, partition, destination + i * PGSIZE, run, PIP_MAP_RWX))
+			return -1;
+		i += run;
+	}
+
+	return 0;
+}
+
+/* Removes count pages at consecutive addresses from a child, returns the
+ * number of pages actually removed */
+uint32_t Pip_UnmapRange(uint32_t partition, uint32_t destination, uint32_t count)
+{
+	if(!count)
+		return 0;
+
+	return Pip_RemoveVAddrRange(partition, destination, count);
+}
+
 uint32_t Pip_Notify(uint32_t destination, uint32_t int_no, uint32_t data1, uint32_t data2)
 {
     return Pip_Dispatch(destination, int_no, 0, data1, data2);
@@ -44,11 +44,15 @@
 #include "pic8259.h"
 #include "libc.h"
 #include "maldefines.h"
+#include "physmap.h"
 #include "mmu.h"
 #include "ial_defines.h"
 #include "lapic.h"
 #include "apic.h"
 #include "smp-imps.h"
+#include "trace.h"
+#include "pipstat.h"
+#include "gdt.h"
 
 #define MAX_VINT (uint32_t)0x100
 #define MAX_PCID 4096
@@ -77,7 +81,7 @@ extern uint32_t readCR2(void); //!< Reads CR2 register (faulting address)
 extern int checkChild(const uintptr_t partition, const uint32_t l1, const uintptr_t va);
 
 struct ipdispatchdata {
-    uint32_t type;  /* VINT type   */
+    volatile uint32_t seq; /* Slot sequence, see ipmailboxPush */
     uint32_t data1; /* VINT data 1 */
     uint32_t data2; /* VINT data 2 */
     uint32_t vint;  /* VINT number */
@@ -85,7 +89,100 @@ struct ipdispatchdata {
     uint32_t from;  /* VINT source */
 };
 
-struct ipdispatchdata corebuffers[4];
+/* Inter-core dispatches waiting for a core. Any core may push, only the
+ * owner pops. pending is set while an IPDISPATCH_INT is on its way, so that
+ * dispatches queued in the meantime don't send another one. */
+#define IPMAILBOX_SLOTS 32 /* Power of two */
+#define IPMAILBOX_CORES 16
+
+struct ipmailbox {
+    volatile uint32_t head; /* Next slot to reserve */
+    volatile uint32_t tail; /* Next slot to pop */
+    volatile uint32_t pending;
+    struct ipdispatchdata slot[IPMAILBOX_SLOTS];
+};
+
+struct ipmailbox coremailboxes[IPMAILBOX_CORES];
+
+/**
+ * \fn void ipmailboxInit(void)
+ * \brief Marks every mailbox slot free for its first lap
+ */
+void ipmailboxInit(void)
+{
+    uint32_t cid, i;
+    for(cid = 0; cid < IPMAILBOX_CORES; cid++)
+        for(i = 0; i < IPMAILBOX_SLOTS; i++)
+            coremailboxes[cid].slot[i].seq = i;
+}
+
+/**
+ * \fn static uint32_t ipmailboxPush(struct ipmailbox *mb, uint32_t partition, uint32_t vint, uint32_t data1, uint32_t data2, uint32_t from)
+ * \brief Queues a dispatch in a core's mailbox
+ * \return 1 if queued, 0 if the mailbox is full
+ * \note A slot is free when its seq equals the position to reserve, and
+ *       holds a message when it equals that position plus one.
+ */
+static uint32_t
+ipmailboxPush(struct ipmailbox *mb, uint32_t partition, uint32_t vint,
+        uint32_t data1, uint32_t data2, uint32_t from)
+{
+    uint32_t pos = mb->head;
+    struct ipdispatchdata *d;
+
+    for(;;)
+    {
+        d = &mb->slot[pos & (IPMAILBOX_SLOTS - 1)];
+        int32_t diff = (int32_t)(d->seq - pos);
+        if(diff == 0) {
+            if(__sync_bool_compare_and_swap(&mb->head, pos, pos + 1))
+                break;
+        } else if(diff < 0) {
+            return 0;
+        }
+        pos = mb->head;
+    }
+
+    d->data1 = data1;
+    d->data2 = data2;
+    d->vint = vint;
+    d->to = partition;
+    d->from = from;
+    __sync_synchronize();
+    d->seq = pos + 1;
+    return 1;
+}
+
+/**
+ * \fn static uint32_t ipmailboxPop(struct ipmailbox *mb, struct ipdispatchdata *out)
+ * \brief Takes the oldest dispatch out of the current core's mailbox
+ * \return 1 if a dispatch was taken, 0 if the mailbox is empty
+ */
+static uint32_t
+ipmailboxPop(struct ipmailbox *mb, struct ipdispatchdata *out)
+{
+    uint32_t pos = mb->tail;
+    struct ipdispatchdata *d = &mb->slot[pos & (IPMAILBOX_SLOTS - 1)];
+
+    if(d->seq != pos + 1)
+        return 0;
+    __sync_synchronize();
+    *out = *d;
+    __sync_synchronize();
+    d->seq = pos + IPMAILBOX_SLOTS;
+    mb->tail = pos + 1;
+    return 1;
+}
+
+/**
+ * \fn static uint32_t ipmailboxWaiting(struct ipmailbox *mb)
+ * \brief Tells whether a dispatch, even half-written, is waiting in the mailbox
+ */
+static uint32_t
+ipmailboxWaiting(struct ipmailbox *mb)
+{
+    return mb->head != mb->tail;
+}
 
 /**
  * \fn isKernel(uint32_t cs)
@@ -273,7 +370,7 @@ static inline uint32_t readPD(uint32_t partition)
    - we can get paddr of child /w checkChild
    - vidt should be written in the partition descriptor by createPartition.
    */
-    static uint32_t
+    uint32_t
 readPaddr(uint32_t partition, uint32_t vaddr)
 {
     uint32_t t, v;
@@ -306,6 +403,289 @@ static uint32_t readVidt(uint32_t descr)
     return readPaddr(descr, (IS_MPMT ? 0xfffff000 - (0x1000 * coreId()) : 0xfffff000));
 }
 
+/* Per-core cache of what dispatch and resume read from partition descriptors.
+ * An entry is valid while its generation is the current one : the pipcalls
+ * that may unmap a VIDT or free a descriptor bump the generation, which drops
+ * the entries of every core at once. */
+#define PDCACHE_WAYS    4
+#define PDCACHE_CORES   16
+
+struct pdcache_entry {
+    uint32_t partition; /* Descriptor paddr */
+    uint32_t generation;
+    uint32_t pd;        /* Page directory paddr */
+    uint32_t vidt;      /* VIDT paddr, -1 if none */
+    uint32_t parent;    /* Parent descriptor paddr */
+    uint32_t caller;    /* Descriptor vaddr in the parent */
+};
+
+struct pdcache {
+    uint32_t next; /* Way to replace on the next miss */
+    struct pdcache_entry way[PDCACHE_WAYS];
+};
+
+static struct pdcache pdcaches[PDCACHE_CORES];
+static volatile uint32_t pdcacheGeneration = 1; /* Blank entries are never valid */
+
+/**
+ * \fn void pdcacheInvalidate(void)
+ * \brief Drops the descriptor cache of every core
+ */
+void pdcacheInvalidate(void)
+{
+    __sync_fetch_and_add(&pdcacheGeneration, 1);
+}
+
+/**
+ * \fn static void pdcacheGet(uint32_t partition, struct pdcache_entry *e)
+ * \brief Gets the descriptor fields of a partition, from the core's cache if possible
+ * \param partition The partition descriptor, as a physical address
+ * \param e Storage for the fields
+ */
+static void pdcacheGet(uint32_t partition, struct pdcache_entry *e)
+{
+    /* Read the generation first : an invalidation while we fill makes the entry stale */
+    uint32_t generation = pdcacheGeneration;
+    uint32_t core = tssCoreId();
+    struct pdcache *c = 0;
+    uint32_t i;
+
+    if(core < PDCACHE_CORES)
+    {
+        c = &pdcaches[core];
+        for(i = 0; i < PDCACHE_WAYS; i++)
+        {
+            if(c->way[i].partition == partition && c->way[i].generation == generation)
+            {
+                *e = c->way[i];
+                return;
+            }
+        }
+    }
+
+    e->partition = partition;
+    e->generation = generation;
+    e->pd = readPhysicalNoFlags(partition, indexPD() + 1);
+    e->vidt = readVidt(partition);
+    e->parent = readPhysicalNoFlags(partition, PPRidx() + 1);
+    e->caller = readPhysicalNoFlags(partition, indexPR());
+
+    /* Partitions without a VIDT yet are looked up again next time */
+    if(c && e->vidt != (uint32_t)-1)
+    {
+        c->way[c->next] = *e;
+        c->next = (c->next + 1) % PDCACHE_WAYS;
+    }
+}
+
+/* Hardware IRQ routing. Each line belongs to the root partition unless it
+ * was handed down to a descendant with irqRouteGlue : the owner then gets
+ * the IRQ directly. An IRQ is latched in its core's pending mask first, and
+ * delivered as soon as its owner is not VCLI'd : right away, with the next
+ * IRQ of the core, or when the owner is resumed with interrupts enabled.
+ * Delegated lines are only handled by the BSP, which the IO APIC targets. */
+#define IRQ_VECTOR      32
+#define IRQ_LINES       16
+#define IRQ_DEPTH_MAX   64 /* Bounds the ancestor walk of irqRoutesBelow */
+
+static volatile uint32_t irqRoute[IRQ_LINES]; /* Owner descriptor paddr, 0 for root */
+static volatile uint32_t irqPending[PDCACHE_CORES]; /* Bit n : IRQ n latched */
+
+/**
+ * \fn static uint32_t irqOwner(uint32_t line)
+ * \brief Gets the partition an IRQ line is delivered to
+ */
+static uint32_t irqOwner(uint32_t line)
+{
+    uint32_t owner = irqRoute[line];
+    return owner ? owner : PARTITION_ROOT;
+}
+
+/**
+ * \fn static uint32_t irqCaller(uint32_t owner)
+ * \brief Gets the caller argument of an IRQ dispatched to a partition
+ * \note The root gets the interrupted partition as before, a delegate gets
+ *       -1 : it cannot address the interrupted partition anyway.
+ */
+static uint32_t irqCaller(uint32_t owner)
+{
+    return owner == PARTITION_ROOT ? PARTITION_CURRENT : (uint32_t)-1;
+}
+
+/**
+ * \fn static uint32_t irqClaim(uint32_t partition)
+ * \brief Takes the lowest IRQ latched on this core for a given owner
+ * \param partition The owner, or 0 for any owner that is not VCLI'd
+ * \return The IRQ line, IRQ_LINES if there is none
+ */
+static uint32_t irqClaim(uint32_t partition)
+{
+    uint32_t core = tssCoreId();
+    uint32_t line, bit, owner;
+    struct pdcache_entry e;
+
+    if(core >= PDCACHE_CORES)
+        return IRQ_LINES;
+
+    for(line = 0; line < IRQ_LINES && irqPending[core]; line++)
+    {
+        bit = 1 << line;
+        if(!(irqPending[core] & bit))
+            continue;
+        owner = irqOwner(line);
+        if(partition && owner != partition)
+            continue;
+        if(!partition)
+        {
+            pdcacheGet(owner, &e);
+            if(e.vidt == (uint32_t)-1)
+            {
+                /* The owner lost its VIDT : the line goes back to the root */
+                IAL_DEBUG(WARNING, "IRQ %d owner %x has no VIDT, routing it to root\n", line, owner);
+                irqRoute[line] = 0;
+                owner = PARTITION_ROOT;
+                pdcacheGet(owner, &e);
+            }
+            if(readPhysical(e.vidt, getTableSize() - 1) & 0x1)
+                continue;
+        }
+        if(__sync_fetch_and_and(&irqPending[core], ~bit) & bit)
+            return line;
+    }
+    return IRQ_LINES;
+}
+
+/**
+ * \fn static uint32_t irqRoutesBelow(uint32_t partition)
+ * \brief Lists the IRQ lines owned by a partition or one of its descendants
+ * \return A mask of IRQ lines
+ */
+static uint32_t irqRoutesBelow(uint32_t partition)
+{
+    uint32_t root = PARTITION_ROOT;
+    uint32_t line, depth, t, mask = 0;
+    struct pdcache_entry e;
+
+    for(line = 0; line < IRQ_LINES; line++)
+    {
+        for(t = irqRoute[line], depth = 0; t && t != root && depth < IRQ_DEPTH_MAX; depth++)
+        {
+            if(t == partition)
+            {
+                mask |= 1 << line;
+                break;
+            }
+            pdcacheGet(t, &e);
+            t = e.parent;
+        }
+    }
+    return mask;
+}
+
+/**
+ * \fn uint32_t irqRouteGlue(uint32_t irq, uint32_t child)
+ * \brief Hands a hardware IRQ line to a child partition
+ * \param irq The IRQ line, 0 to 15
+ * \param child The child descriptor, as a virtual address of the caller, or 0
+ *        to give the line back to the root partition
+ * \return 1 on success, 0 if the caller does not own the line or child is invalid
+ * \note The root partition may route any line, other partitions only the
+ *       lines they own, so a line can be handed down the partition tree.
+ */
+uint32_t irqRouteGlue(uint32_t irq, uint32_t child)
+{
+    uint32_t caller = PARTITION_CURRENT;
+    uint32_t core, to = 0;
+    struct pdcache_entry e;
+
+    if(irq >= IRQ_LINES)
+        return 0;
+    if(caller != PARTITION_ROOT && caller != irqOwner(irq))
+    {
+        IAL_DEBUG(WARNING, "Partition %x tried to route IRQ %d it does not own\n", caller, irq);
+        return 0;
+    }
+
+    if(child)
+    {
+        if(!checkChild(caller, getNbLevel(), child))
+        {
+            IAL_DEBUG(WARNING, "Partition %x tried to route IRQ %d to invalid child %x\n", caller, irq, child);
+            return 0;
+        }
+        to = readPaddr(caller, child);
+        if(to == (uint32_t)-1)
+            return 0;
+        pdcacheGet(to, &e);
+        if(e.vidt == (uint32_t)-1)
+            return 0;
+    }
+
+    irqRoute[irq] = to;
+    /* Latched IRQs were meant for the previous owner */
+    for(core = 0; core < PDCACHE_CORES; core++)
+        __sync_fetch_and_and(&irqPending[core], ~(1 << irq));
+    return 1;
+}
+
+/* Pipcalls that may unmap a VIDT or free a descriptor */
+extern uint32_t deletePartition(uint32_t);
+extern uint32_t collect(uint32_t, uint32_t);
+extern uint32_t removeVAddr(uint32_t, uint32_t);
+
+/**
+ * \fn uint32_t deletePartitionGlue(uint32_t child)
+ * \brief deletePartition, dropping the descriptor caches, the IRQ routes and the IO grants
+ */
+uint32_t deletePartitionGlue(uint32_t child)
+{
+    uint32_t routes = 0, grants = 0;
+    uint32_t line, ret;
+
+    /* Lines owned by the child or below it go back to the root, and its
+     * IO ports are revoked. Both are listed while the descriptors can still
+     * be walked, and only dropped once the delete succeeded */
+    if(checkChild(PARTITION_CURRENT, getNbLevel(), child))
+    {
+        uint32_t descriptor = readPaddr(PARTITION_CURRENT, child);
+        routes = irqRoutesBelow(descriptor);
+        grants = ioGrantsBelow(descriptor);
+    }
+
+    ret = deletePartition(child);
+    if(ret)
+    {
+        for(line = 0; line < IRQ_LINES; line++)
+            if(routes & (1 << line))
+                irqRoute[line] = 0;
+        ioGrantDrop(grants);
+    }
+    pdcacheInvalidate();
+    return ret;
+}
+
+/**
+ * \fn uint32_t collectGlue(uint32_t descriptor, uint32_t vaddr)
+ * \brief collect, dropping the descriptor caches
+ */
+uint32_t collectGlue(uint32_t descriptor, uint32_t vaddr)
+{
+    uint32_t ret = collect(descriptor, vaddr);
+    pdcacheInvalidate();
+    return ret;
+}
+
+/**
+ * \fn uint32_t removeVAddrGlue(uint32_t child, uint32_t vaddr)
+ * \brief removeVAddr, dropping the descriptor caches
+ */
+uint32_t removeVAddrGlue(uint32_t child, uint32_t vaddr)
+{
+    uint32_t ret = removeVAddr(child, vaddr);
+    pdcacheInvalidate();
+    return ret;
+}
+
 /**
  * \fn void readVidtInfo(uint32_t vidt, uint32_t vint_no, uint32_t *eip, uint32_t *esp, uint32_t *flags)
  * \brief Reads the information stored into the VIDT for the given partition and interrupt number
@@ -370,12 +750,14 @@ saveCurrentUserContext(uint32_t eip, uint32_t eflags, const pushad_regs_t *regs,
     uint32_t vidt;
     user_ctx_t *ctx;
     uint32_t partition = getCurPartition();
+    struct pdcache_entry pc;
 
     DEBUG (TRACE, "Save context of partition %x at ip %x sp %x (%x)\n",
             partition, eip, regs->esp, 0x800 + 0x40*(index) );
 
     /* read vidt paddr*/
-    if ((vidt=readVidt(partition)) == (uint32_t)-1){
+    pdcacheGet(partition, &pc);
+    if ((vidt=pc.vidt) == (uint32_t)-1){
         DEBUG(WARNING, "No vidt in partition %x\n", partition);
         return;
     }
@@ -387,11 +769,11 @@ saveCurrentUserContext(uint32_t eip, uint32_t eflags, const pushad_regs_t *regs,
 */
 
     /* ploploplop (FIXME) */
-    disable_paging();
-    ctx = (user_ctx_t*)(vidt + 0x800 + 0x40*index);
+    PHYS_BEGIN();
+    ctx = (user_ctx_t*)PHYS_ENTRY(vidt, (0x800 + 0x40*index) / sizeof(uint32_t));
 
     ctx->eip = eip;
-    ctx->pipflags = *(uint32_t*)(vidt+0xffc);
+    ctx->pipflags = *PHYS_ENTRY(vidt, 0xffc / sizeof(uint32_t));
     ctx->eflags = eflags;
     ctx->regs = *regs;
 
@@ -402,7 +784,7 @@ saveCurrentUserContext(uint32_t eip, uint32_t eflags, const pushad_regs_t *regs,
     }
     ctx->valid = 1;
 
-    enable_paging();
+    PHYS_END();
 }
 
 /**
@@ -424,21 +806,14 @@ void yieldRootPartition(void)
 genericHandler (int_ctx_t *is)
 {
     uint32_t vint, target, from, data1, data2;
+    uint32_t intno = is->int_no;
+    TRACE_EVENT(TRACE_EV_INTERRUPT, is->int_no, is->eip, is->err_code, 0);
     if(is->int_no == 0x2) /* NMI */
     {
         /* The interrupt has to be handled NOW. */
         write_lapic(APIC_EOI, 0x0); /* Write EOI */
 
-        /* Do some NMI-related stuff here */
-        /* Type 0x1 : inter-processor dispatch */
-        if(corebuffers[coreId()].type == 0x1) {
-            IAL_DEBUG(CRITICAL, "MultiThread : inter-processor dispatch through NMIPI\n");
-            target = corebuffers[coreId()].to;
-            from = corebuffers[coreId()].from;
-            if(!isKernel(is->cs)) saveCaller(is);
-            IAL_DEBUG(CRITICAL, "MultiThread : dispatching interrupt %d to partition %x\n", corebuffers[coreId()].vint, target);
-            dispatch2(target, corebuffers[coreId()].vint, corebuffers[coreId()].data1, corebuffers[coreId()].data2, from);
-        }
+        /* Inter-core dispatches now come through IPDISPATCH_INT */
 
         /* Return from interrupt */
         return;
@@ -462,51 +837,61 @@ genericHandler (int_ctx_t *is)
             outb (PIC2_COMMAND, PIC_EOI);
         outb (PIC1_COMMAND, PIC_EOI);
 
-        /* Propagate to all cores */
-        if(coreId() == 0x0 && IS_MPST) { /* BSP on single-thread - on multithread, root should handle interrupts in her own way */
+        /* Propagate root-owned lines to all cores */
+        uint32_t line = is->int_no - IRQ_VECTOR;
+        uint32_t core = tssCoreId();
+        if(core == 0x0 && IS_MPST && !irqRoute[line]) { /* BSP on single-thread - on multithread, root should handle interrupts in her own way */
             //   DEBUG(CRITICAL, "Propagating hardware interrupt %x to all cores\n", is->int_no);
             send_vipi(0x0, is->int_no, 0x0);
         }
 
-        /* Ignore kernel-land IRQ */
+        /* Latch the IRQ, delegated lines only on the BSP. Nothing can be
+         * latched before the core loaded its TSS, as in irqClaim */
+        if(core < PDCACHE_CORES && (core == 0x0 || !irqRoute[line]))
+            __sync_fetch_and_or(&irqPending[core], 1 << line);
+
+        /* Kernel-land IRQ stay latched */
         if (isKernel(is->cs))
         {
-            IAL_DEBUG (TRACE, "Ignoring kernel-land IRQ.\n");
+            IAL_DEBUG (TRACE, "Latching kernel-land IRQ.\n");
             return;
         }
 
         IAL_DEBUG(TRACE, "Current partition is %x, root partition is %x.\n", PARTITION_CURRENT, PARTITION_ROOT);
 
-        /* Special case : root partition might be running - TODO : remove this when it gets stable */
-        /*if(PARTITION_CURRENT == PARTITION_ROOT)
-          {
-          IAL_DEBUG(TRACE, "Ignoring hardware interrupt while root partition is running.\n");
-          return;
-          }*/
-
-        /* Special case : root partition might be VCLI'd - check this */
-        uintptr_t rootVidt = readVidt(PARTITION_ROOT);
-
-        IAL_DEBUG(TRACE, "Root VIDT at %x.\n", rootVidt);
-        uint32_t flags = readPhysical(rootVidt, getTableSize()-1); /* *(uint32_t*)(rootVidt + 0x1000 - sizeof(uint32_t)); */
-        IAL_DEBUG(TRACE, "Root VIDT flags are set to %x.\n", flags);
-        if(flags & 0x1)
+        /* Special case : owners might be VCLI'd - then the IRQ waits */
+        line = irqClaim(0);
+        if(line == IRQ_LINES)
         {
-            IAL_DEBUG(TRACE, "Ignoring hardware interrupt while root partition is busy.\n");
+            IAL_DEBUG(TRACE, "Latching hardware interrupt while its owner is busy.\n");
             return;
         }
 
-        /* Set target as root partition */
-        target = PARTITION_ROOT;
-        from = PARTITION_CURRENT;
+        /* Set target as the line's owner */
+        intno = IRQ_VECTOR + line;
+        target = irqOwner(line);
+        from = irqCaller(target);
 
     } else {
         /* Multicore dispatch */
         if(is->int_no == IPDISPATCH_INT) {
-            target = corebuffers[coreId()].to;
-            from = corebuffers[coreId()].from;
+            uint32_t cid = coreId();
+            struct ipmailbox *mb = &coremailboxes[cid];
+            struct ipdispatchdata d;
+
+            /* Producers queueing from now on have to send a new IPI */
+            mb->pending = 0;
+            __sync_synchronize();
+            if(!ipmailboxPop(mb, &d))
+                return;
+
+            /* One dispatch per interrupt, as dispatch2 does not return : the
+             * rest is delivered by a self-IPI once the partition runs again */
+            if(ipmailboxWaiting(mb) && !__sync_lock_test_and_set(&mb->pending, 1))
+                SEND_VECIPI(cid, IPDISPATCH_INT);
+
             saveCaller(is); /* Save interrupted context, if any */
-            dispatch2(target, corebuffers[coreId()].vint, corebuffers[coreId()].data1, corebuffers[coreId()].data2, from);
+            dispatch2(d.to, d.vint, d.data1, d.data2, d.from);
         } else {
             IAL_DEBUG(CRITICAL, "Got fault interrupt %d by %X.\n", is->int_no,PARTITION_CURRENT);
             IAL_DEBUG(CRITICAL, "\n\nEIP at %x in partition %x\n\n", is->eip,is->useresp);
@@ -545,7 +930,7 @@ genericHandler (int_ctx_t *is)
     }
 
     /* Our virtual interrupt number, skipping reset/resume */
-    vint = is->int_no + 1;
+    vint = intno + 1;
     if (vint >= MAX_VINT)
     {
         IAL_DEBUG(ERROR, "Invalid interrupt number %x ?\n", vint);
@@ -572,20 +957,26 @@ genericHandler (int_ctx_t *is)
 ipdispatch (uint32_t partition, uint32_t vint,
         uint32_t data1, uint32_t data2, uint32_t cid)
 {
-    IAL_DEBUG(CRITICAL, "Requested inter-core dispatch of VINT %d to partition %x, target core is %x.\n", vint, partition, cid);
-    uint32_t vidt, eip, esp, vflags;
+    TRACE_EVENT(TRACE_EV_IPDISPATCH, partition, vint, cid, data1);
+    IAL_DEBUG(TRACE, "Requested inter-core dispatch of VINT %d to partition %x, target core is %x.\n", vint, partition, cid);
+
+    if(cid >= IPMAILBOX_CORES)
+    {
+        IAL_DEBUG(WARNING, "Inter-core dispatch to unknown core %x, dropped\n", cid);
+        return;
+    }
 
-    /* Put interrupt data into core buffer */
-    corebuffers[cid].data1 = data1;
-    corebuffers[cid].data2 = data2;
-    corebuffers[cid].vint = vint;
-    corebuffers[cid].to = partition;
-    corebuffers[cid].from = coreId();
-    corebuffers[cid].type = 0x1;
+    /* Queue the dispatch in the target core's mailbox */
+    struct ipmailbox *mb = &coremailboxes[cid];
+    if(!ipmailboxPush(mb, partition, vint, data1, data2, coreId()))
+    {
+        IAL_DEBUG(WARNING, "Mailbox of core %x is full, dispatch dropped\n", cid);
+        return;
+    }
 
-    /* Send IPI to target core */
-    //send_vipi(cid, IPDISPATCH_INT, 0x0);
-    SEND_NMIPI(cid);
+    /* Send IPI to target core, unless one is already on its way */
+    if(!__sync_lock_test_and_set(&mb->pending, 1))
+        SEND_VECIPI(cid, IPDISPATCH_INT);
     return;
 }
 
@@ -604,7 +995,7 @@ dispatchGlue (uint32_t descriptor, uint32_t vint, uint32_t cid,
     uint32_t to, from;
     /* DEBUG(CRITICAL, "TRACE: dispatch called for part %x, vint %d\n", descriptor, vint);	 */
     /* First, save caller context */
-    IAL_DEBUG(CRITICAL, "Userland called dispatch(); saving context\n");
+    IAL_DEBUG(TRACE, "Userland called dispatch(); saving context\n");
 
     /* For now, context is saved by SYSENTER - don't do this again */
     //    saveCallgateCaller(ctx);
@@ -622,15 +1013,16 @@ dispatchGlue (uint32_t descriptor, uint32_t vint, uint32_t cid,
                 IAL_DEBUG(CRITICAL, "Root partition has no parent; incoherent behavior, halting\n");
                 panic(0);
             } else { /* Allow inter-core dispatches to root partitions */
-                IAL_DEBUG(CRITICAL, "Allowing inter-core dispatch to root from core %d to core %d\n", coreId(), cid);
+                IAL_DEBUG(TRACE, "Allowing inter-core dispatch to root from core %d to core %d\n", coreId(), cid);
                 to = PARTITION_ROOT;
                 from = PARTITION_CURRENT;
             }
         } else {
-            /* Get PAddr of Parent Partition */
-            to = readPhysicalNoFlags(PARTITION_CURRENT, PPRidx()+1);
-            /* Get VAddr of caller in parent partition */
-            from = readPhysicalNoFlags(PARTITION_CURRENT, indexPR());
+            /* Get PAddr of Parent Partition and VAddr of caller in parent partition */
+            struct pdcache_entry pc;
+            pdcacheGet(PARTITION_CURRENT, &pc);
+            to = pc.parent;
+            from = pc.caller;
         }
     }
     /* A parent notifies a child */
@@ -678,39 +1070,49 @@ dispatchGlue (uint32_t descriptor, uint32_t vint, uint32_t cid,
 dispatch2 (uint32_t partition, uint32_t vint,
         uint32_t data1, uint32_t data2, uint32_t caller)
 {
-    IAL_DEBUG(CRITICAL, "Requested dispatch of VINT %d to partition %x, caller is %x.\n", vint, partition, caller);
-    uint32_t vidt, eip, esp, vflags;
+    TRACE_EVENT(TRACE_EV_DISPATCH, partition, vint, caller, data1);
+    IAL_DEBUG(TRACE, "Requested dispatch of VINT %d to partition %x, caller is %x.\n", vint, partition, caller);
+    uint32_t eip, esp, vflags;
+    struct pdcache_entry pc;
+    uint32_t *vidt;
 
     /* Check interrupt range */
     ASSERT(vint < MAX_VINT);
 
     /* Check VIDT validity */
-    if(!((vidt=readVidt(partition)) != (uint32_t)-1))
+    pdcacheGet(partition, &pc);
+    if(pc.vidt == (uint32_t)-1)
     {
         IAL_DEBUG(CRITICAL, "0ops. Partition=%x, vint=%x, caller=%x\n", partition, vint, caller);
         ASSERT(0);
     }
 
-    /* Read VIDT info */
-    readVidtInfo(vidt, vint, &eip, &esp, &vflags);
-
-    /* VCLI the partition */
-    IAL_DEBUG(CRITICAL, "Dispatch2: VCLI'd vidt @%x.\n", vidt);
-    writePhysical(vidt, getTableSize()-1, vflags|1);
-
     /* Activate partition */
-    IAL_DEBUG(CRITICAL, "Switching to partition %x's Page Directory.\n", partition);
+    IAL_DEBUG(TRACE, "Switching to partition %x's Page Directory.\n", partition);
     updateCurPartition (partition);
+    ioBitmapSwitch(partition);
     if(pcid_enabled)
-        activate(readPhysicalNoFlags(partition, indexPD () + 1) | readPhysical(partition, 12));
+        activate(pc.pd | readPhysical(partition, 12));
     else
-        activate(readPhysicalNoFlags(partition, indexPD () + 1));
+        activate(pc.pd);
+
+    /* The partition's VIDT is mapped at VIDT now : read it without
+     * going through physical memory */
+    vidt = (uint32_t*)VIDT;
+    eip = vidt[2 * vint];
+    esp = vidt[(2 * vint) + 1];
+    vflags = vidt[getTableSize() - 1];
 
-    IAL_DEBUG(CRITICAL, "Dispatching to eip %x, esp %x, data1 %x, data2 %x, caller %x\n", eip, esp, data1, data2, caller)
+    /* VCLI the partition */
+    IAL_DEBUG(TRACE, "Dispatch2: VCLI'd vidt @%x.\n", pc.vidt);
+    vidt[getTableSize() - 1] = vflags | 1;
+
+    IAL_DEBUG(TRACE, "Dispatching to eip %x, esp %x, data1 %x, data2 %x, caller %x\n", eip, esp, data1, data2, caller)
 
     /* Switch execution to userland */
     extern void dispatchAsm(uintptr_t eip, uintptr_t esp, uint32_t data1,
             uint32_t data2, uint32_t caller);
+    pipcallStatLeave();
     dispatchAsm (eip, esp, data1, data2, caller);
 }
 
@@ -722,8 +1124,9 @@ dispatch2 (uint32_t partition, uint32_t vint,
 void resume (uint32_t descriptor, uint32_t pipflags)
 {
     uintptr_t to, from;
+    struct pdcache_entry pc;
 
-    IAL_DEBUG(WARNING, "Partition %x asked for a resume %x with flags %x.\n",PARTITION_CURRENT,descriptor,pipflags);
+    IAL_DEBUG(TRACE, "Partition %x asked for a resume %x with flags %x.\n",PARTITION_CURRENT,descriptor,pipflags);
 
     /* On a resume() call we consider the parent's job done - forget about the context ? */
 
@@ -735,10 +1138,10 @@ void resume (uint32_t descriptor, uint32_t pipflags)
             to = PARTITION_ROOT;
             from = PARTITION_ROOT;
         } else {
-            /* Get PAddr of Parent Partition */
-            to = readPhysicalNoFlags(PARTITION_CURRENT, PPRidx()+1);
-            /* Get VAddr of caller in parent partition */
-            from = readPhysicalNoFlags(PARTITION_CURRENT, indexPR());
+            /* Get PAddr of Parent Partition and VAddr of caller in parent partition */
+            pdcacheGet(PARTITION_CURRENT, &pc);
+            to = pc.parent;
+            from = pc.caller;
         }
     }
     else if (descriptor == 0xFFFFFFFF)
@@ -768,29 +1171,44 @@ void resume (uint32_t descriptor, uint32_t pipflags)
     }
 
     /* Activate partition */
-    IAL_DEBUG(CRITICAL, "Switching to partition %x's Page Directory\n", to);
+    TRACE_EVENT(TRACE_EV_RESUME, descriptor, to, pipflags, 0);
+    IAL_DEBUG(TRACE, "Switching to partition %x's Page Directory\n", to);
+    pdcacheGet(to, &pc);
     updateCurPartition (to);
+    ioBitmapSwitch(to);
     if(pcid_enabled)
-        activate(readPhysicalNoFlags(to, indexPD () + 1) | readPhysical(to, 12));
+        activate(pc.pd | readPhysical(to, 12));
     else
-        activate(readPhysicalNoFlags(to, indexPD () + 1));
+        activate(pc.pd);
 
     /* Get interrupted context info - FIXME: stack only ? */
     uintptr_t int_ctx;
-    IAL_DEBUG(CRITICAL, "PIPFLAGS is %x\n", *PIPFLAGS);
+    IAL_DEBUG(TRACE, "PIPFLAGS is %x\n", *PIPFLAGS);
     if(VIDT_VCLI)
     {
         int_ctx = (uintptr_t)VIDT_CTX_BUFFER;
-        IAL_DEBUG(CRITICAL, "Interrupted context should be at %x\n", VIDT_CTX_BUFFER);
+        IAL_DEBUG(TRACE, "Interrupted context should be at %x\n", VIDT_CTX_BUFFER);
     } else
     {
         int_ctx = VIDT_INT_ESP(0);
-        IAL_DEBUG(CRITICAL, "Interrupted context should be at %x\n", int_ctx);
+        IAL_DEBUG(TRACE, "Interrupted context should be at %x\n", int_ctx);
     }
     int_ctx_t* intctx = (int_ctx_t*)int_ctx;
     dumpRegs(intctx, TRACE);
     /* dumpRegs(intctx); */
 
+    /* An IRQ latched for the partition is delivered instead, as if it had
+     * interrupted the partition right after the resume */
+    uint32_t line;
+    if(!(pipflags & 0x1) && (line = irqClaim(to)) != IRQ_LINES)
+    {
+        int_ctx_t is;
+        memcpy((void*)&is, intctx, SIZEOF_CTX);
+        *PIPFLAGS = pipflags;
+        IAL_DEBUG(TRACE, "Delivering latched IRQ %d to partition %x.\n", line, to);
+        dispatch2(to, IRQ_VECTOR + line + 1, 0, saveCaller(&is), irqCaller(to));
+    }
+
     /* Build user context from interrupted context */
     user_ctx_t ctxToResume;
     ctxToResume.eip = intctx->eip;
@@ -799,15 +1217,16 @@ void resume (uint32_t descriptor, uint32_t pipflags)
     memcpy((void*)&(ctxToResume.regs), &(intctx->regs), sizeof(pushad_regs_t));
     ctxToResume.regs.esp = intctx->useresp;
     ctxToResume.valid = 0;
-    IAL_DEBUG(CRITICAL,"NEXT CTX :  \r\n\t\t EIP : %x \
+    IAL_DEBUG(TRACE,"NEXT CTX :  \r\n\t\t EIP : %x \
                                     \r\n\t\t PIPFLAGS : %x \
                                     \r\n\t\t EFLAGS : %x \
                                     \r\n\t\t ESP : %x \
                                     \r\n\t\t valid : %x\r\n", ctxToResume.eip,ctxToResume.pipflags,ctxToResume.eflags,ctxToResume.regs.esp,ctxToResume.valid);
 
-    IAL_DEBUG(CRITICAL, "Going back to userland.\n");
+    IAL_DEBUG(TRACE, "Going back to userland.\n");
 
     extern void resumeAsm(user_ctx_t*);
+    pipcallStatLeave();
     resumeAsm(&ctxToResume);
 
     ASSERT(0);
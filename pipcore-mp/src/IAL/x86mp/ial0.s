@@ -120,7 +120,7 @@ readCR2:
 dispatchAsm:
 	; (eip, esp, data1, data2, caller)
 	cli
-    call release
+    call release	; Pipcall lock, only if this core holds one
 	;call api_unlock	; Unlock spinlock
 	mov	ebp, esp
 	; user data segment
@@ -151,7 +151,7 @@ dispatchAsm:
 
 [GLOBAL resumeAsm]
 resumeAsm:
-    call release
+    call release	; Pipcall lock, only if this core holds one
 	;call api_unlock	; Release spinlock
 ; (user_ctx_s *ctx)
 	mov	eax, [esp+4]
@@ -167,9 +167,10 @@ resumeAsm:
 	push	0x23
 ; (userland esp)
 	push	dword [eax+0x18]
-; eflags + restore interrupts
+; eflags + restore interrupts, IOPL stays 0 : ports go through the TSS bitmap
 	push	dword [eax+8]
 	or	dword [esp], 0x200
+	and	dword [esp], ~0x3000
 ; user eip:cs
 	push	0x1b
 	push	dword [eax]
@@ -184,6 +185,11 @@ resumeAsm:
 	; switch to context
 	iret
 
+; LAPIC spurious interrupt : not in service, so no EOI and nothing to do
+global isrSpurious
+isrSpurious:
+	iret
+
 ; Definition of each interrupt handler for x86 (0-31 : faults, 32-47 : IRQ)
 ISR_NOERRCODE 0
 ISR_NOERRCODE 1
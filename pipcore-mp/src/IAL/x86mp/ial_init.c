@@ -409,6 +409,9 @@ bindIsr (void)
     USER_IDT(254);
     USER_IDT(255);
 
+    /* Kernel-only, a spurious interrupt must not reach genericHandler */
+    idtSetGate(APIC_SPURIOUS_INT, (uint32_t) isrSpurious, 0x08, 0x8E);
+
     idtFlush (& idt_ptr);
     IAL_DEBUG (INFO, "Flushed IDT with fault and soft. int entries\n");
 }
@@ -545,10 +548,11 @@ void enable_apic() {
     /* Hardware enable the Local APIC if it wasn't enabled */
     cpu_set_apic_base(cpu_get_apic_base());
 
-    /* Set the Spourious Interrupt Vector Register bit 8 to start receiving interrupts */
+    /* Set the Spourious Interrupt Vector Register bit 8 to start receiving interrupts,
+     * and move the spurious vector off 0xFF, which is the dispatch IPI */
     extern uint32_t* lapic_base;
-    uint32_t cur = *(uint32_t*)((uint32_t)lapic_base + 0xF0);
-    *(uint32_t*)((uint32_t)lapic_base + 0xF0) = cur | 0x100;
+    uint32_t cur = *(uint32_t*)((uint32_t)lapic_base + APIC_SPURIOUS);
+    *(uint32_t*)((uint32_t)lapic_base + APIC_SPURIOUS) = (cur & ~0xFF) | APIC_SW_ENABLE | APIC_SPURIOUS_INT;
 }
 
 /* Sets up the APIC */
@@ -648,6 +652,8 @@ initInterrupts (void)
         setup_apic_timer();
         // timerPhase (100);
         timer_ticks = 0;
+        /* Before APs come up and start dispatching */
+        ipmailboxInit();
         initCpu();
     } else {
         DEBUG(CRITICAL, "Running IAL initialization for AP%d.\n", coreId());
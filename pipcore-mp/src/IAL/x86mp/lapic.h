@@ -27,6 +27,10 @@
 #define     TMR_PERIODIC	0x20000
 #define     TMR_BASEDIV     (1<<20)
 
+/* Spurious vector, kept apart from the 0xFF dispatch IPI. P6 and Pentium
+ * hardwire the low nibble to 1s, so it has to end in F. */
+#define     APIC_SPURIOUS_INT   0xEF
+
 uint32_t read_lapic(uint32_t reg);
 void write_lapic(uint32_t reg, uint32_t value);
 
@@ -84,6 +84,9 @@ extern void irq12(); //!< IRQ 12
 extern void irq13(); //!< IRQ 13
 extern void irq14(); //!< IRQ 14
 extern void irq15(); //!< IRQ 15
+extern void isrSpurious(); //!< LAPIC spurious interrupt, see APIC_SPURIOUS_INT
+
+void ipmailboxInit(void); //!< Marks every inter-core mailbox slot free
 
 /**
  * \struct registers
@@ -49,6 +49,9 @@
 #include "lapic.h"
 #include "apic.h"
 #include "smp-imps.h"
+#include "trace.h"
+#include "pipstat.h"
+#include "gdt.h"
 
 #define MAX_VINT (uint32_t)0x100
 #define MAX_PCID 4096
@@ -424,6 +427,7 @@ void yieldRootPartition(void)
 genericHandler (int_ctx_t *is)
 {
     uint32_t vint, target, from, data1, data2;
+    TRACE_EVENT(TRACE_EV_INTERRUPT, is->int_no, is->eip, is->err_code, 0);
     if(is->int_no == 0x2) /* NMI */
     {
         /* The interrupt has to be handled NOW. */
@@ -432,11 +436,11 @@ genericHandler (int_ctx_t *is)
         /* Do some NMI-related stuff here */
         /* Type 0x1 : inter-processor dispatch */
         if(corebuffers[coreId()].type == 0x1) {
-            IAL_DEBUG(CRITICAL, "MultiThread : inter-processor dispatch through NMIPI\r\n");
+            IAL_DEBUG(TRACE, "MultiThread : inter-processor dispatch through NMIPI\r\n");
             target = corebuffers[coreId()].to;
             from = corebuffers[coreId()].from;
             if(!isKernel(is->cs)) saveCaller(is);
-            IAL_DEBUG(CRITICAL, "MultiThread : dispatching interrupt %d to partition %x\r\n", corebuffers[coreId()].vint, target);
+            IAL_DEBUG(TRACE, "MultiThread : dispatching interrupt %d to partition %x\r\n", corebuffers[coreId()].vint, target);
             dispatch2(target, corebuffers[coreId()].vint, corebuffers[coreId()].data1, corebuffers[coreId()].data2, from);
         }
 
@@ -572,7 +576,8 @@ genericHandler (int_ctx_t *is)
 ipdispatch (uint32_t partition, uint32_t vint,
         uint32_t data1, uint32_t data2, uint32_t cid)
 {
-    IAL_DEBUG(CRITICAL, "Requested inter-core dispatch of VINT %d to partition %x, target core is %x.\r\n", vint, partition, cid);
+    TRACE_EVENT(TRACE_EV_IPDISPATCH, partition, vint, cid, data1);
+    IAL_DEBUG(TRACE, "Requested inter-core dispatch of VINT %d to partition %x, target core is %x.\r\n", vint, partition, cid);
     uint32_t vidt, eip, esp, vflags;
 
     /* Put interrupt data into core buffer */
@@ -606,7 +611,7 @@ dispatchGlue (uint32_t descriptor, uint32_t vint, uint32_t cid,
     uint32_t to, from;
     /* DEBUG(CRITICAL, "TRACE: dispatch called for part %x, vint %d\r\n", descriptor, vint);	 */
     /* First, save caller context */
-    IAL_DEBUG(CRITICAL, "Userland called dispatch(); saving context\r\n");
+    IAL_DEBUG(TRACE, "Userland called dispatch(); saving context\r\n");
 
     /* For now, context is saved by SYSENTER - don't do this again */
     //    saveCallgateCaller(ctx);
@@ -624,7 +629,7 @@ dispatchGlue (uint32_t descriptor, uint32_t vint, uint32_t cid,
                 IAL_DEBUG(CRITICAL, "Root partition has no parent; incoherent behavior, halting\r\n");
                 panic(0);
             } else { /* Allow inter-core dispatches to root partitions */
-                IAL_DEBUG(CRITICAL, "Allowing inter-core dispatch to root from core %d to core %d\r\n", coreId(), cid);
+                IAL_DEBUG(TRACE, "Allowing inter-core dispatch to root from core %d to core %d\r\n", coreId(), cid);
                 to = PARTITION_ROOT;
                 from = PARTITION_CURRENT;
             }
@@ -680,7 +685,8 @@ dispatchGlue (uint32_t descriptor, uint32_t vint, uint32_t cid,
 dispatch2 (uint32_t partition, uint32_t vint,
         uint32_t data1, uint32_t data2, uint32_t caller)
 {
-    IAL_DEBUG(CRITICAL, "Requested dispatch of VINT %d to partition %x, caller is %x.\r\n", vint, partition, caller);
+    TRACE_EVENT(TRACE_EV_DISPATCH, partition, vint, caller, data1);
+    IAL_DEBUG(TRACE, "Requested dispatch of VINT %d to partition %x, caller is %x.\r\n", vint, partition, caller);
     uint32_t vidt, eip, esp, vflags;
 
     /* Check interrupt range */
@@ -697,22 +703,23 @@ dispatch2 (uint32_t partition, uint32_t vint,
     readVidtInfo(vidt, vint, &eip, &esp, &vflags);
 
     /* VCLI the partition */
-    IAL_DEBUG(CRITICAL, "Dispatch2: VCLI'd vidt @%x.\r\n", vidt);
+    IAL_DEBUG(TRACE, "Dispatch2: VCLI'd vidt @%x.\r\n", vidt);
     writePhysical(vidt, getTableSize()-1, vflags|1);
 
     /* Activate partition */
-    IAL_DEBUG(CRITICAL, "Switching to partition %x's Page Directory.\r\n", partition);
+    IAL_DEBUG(TRACE, "Switching to partition %x's Page Directory.\r\n", partition);
     updateCurPartition (partition);
     if(pcid_enabled)
         activate(readPhysicalNoFlags(partition, indexPD () + 1) | readPhysical(partition, 12));
     else
         activate(readPhysicalNoFlags(partition, indexPD () + 1));
 
-    IAL_DEBUG(CRITICAL, "Dispatching to eip %x, esp %x, data1 %x, data2 %x, caller %x\r\n", eip, esp, data1, data2, caller)
+    IAL_DEBUG(TRACE, "Dispatching to eip %x, esp %x, data1 %x, data2 %x, caller %x\r\n", eip, esp, data1, data2, caller)
 
     /* Switch execution to userland */
     extern void dispatchAsm(uintptr_t eip, uintptr_t esp, uint32_t data1,
             uint32_t data2, uint32_t caller);
+    pipcallStatLeave();
     dispatchAsm (eip, esp, data1, data2, caller);
 }
 
@@ -725,7 +732,7 @@ void resume (uint32_t descriptor, uint32_t pipflags)
 {
     uintptr_t to, from;
 
-    IAL_DEBUG(WARNING, "Partition %x asked for a resume %x with flags %x.\r\n",PARTITION_CURRENT,descriptor,pipflags);
+    IAL_DEBUG(TRACE, "Partition %x asked for a resume %x with flags %x.\r\n",PARTITION_CURRENT,descriptor,pipflags);
 
     /* On a resume() call we consider the parent's job done - forget about the context ? */
 
@@ -770,7 +777,8 @@ void resume (uint32_t descriptor, uint32_t pipflags)
     }
 
     /* Activate partition */
-    IAL_DEBUG(CRITICAL, "Switching to partition %x's Page Directory\r\n", to);
+    TRACE_EVENT(TRACE_EV_RESUME, descriptor, to, pipflags, 0);
+    IAL_DEBUG(TRACE, "Switching to partition %x's Page Directory\r\n", to);
     updateCurPartition (to);
     if(pcid_enabled)
         activate(readPhysicalNoFlags(to, indexPD () + 1) | readPhysical(to, 12));
@@ -779,15 +787,15 @@ void resume (uint32_t descriptor, uint32_t pipflags)
 
     /* Get interrupted context info - FIXME: stack only ? */
     uintptr_t int_ctx;
-    IAL_DEBUG(CRITICAL, "PIPFLAGS is %x\r\n", *PIPFLAGS);
+    IAL_DEBUG(TRACE, "PIPFLAGS is %x\r\n", *PIPFLAGS);
     if(VIDT_VCLI)
     {
         int_ctx = (uintptr_t)VIDT_CTX_BUFFER;
-        IAL_DEBUG(CRITICAL, "Interrupted context should be at %x\r\n", VIDT_CTX_BUFFER);
+        IAL_DEBUG(TRACE, "Interrupted context should be at %x\r\n", VIDT_CTX_BUFFER);
     } else
     {
         int_ctx = VIDT_INT_ESP(0);
-        IAL_DEBUG(CRITICAL, "Interrupted context should be at %x\r\n", int_ctx);
+        IAL_DEBUG(TRACE, "Interrupted context should be at %x\r\n", int_ctx);
     }
     int_ctx_t* intctx = (int_ctx_t*)int_ctx;
     dumpRegs(intctx, TRACE);
@@ -801,15 +809,16 @@ void resume (uint32_t descriptor, uint32_t pipflags)
     memcpy((void*)&(ctxToResume.regs), &(intctx->regs), sizeof(pushad_regs_t));
     ctxToResume.regs.esp = intctx->useresp;
     ctxToResume.valid = 0;
-    IAL_DEBUG(CRITICAL,"NEXT CTX :  \r\r\n\t\t EIP : %x \
+    IAL_DEBUG(TRACE,"NEXT CTX :  \r\r\n\t\t EIP : %x \
                                     \r\r\n\t\t PIPFLAGS : %x \
                                     \r\r\n\t\t EFLAGS : %x \
                                     \r\r\n\t\t ESP : %x \
                                     \r\r\n\t\t valid : %x\r\r\n", ctxToResume.eip,ctxToResume.pipflags,ctxToResume.eflags,ctxToResume.regs.esp,ctxToResume.valid);
 
-    IAL_DEBUG(CRITICAL, "Going back to userland.\r\n");
+    IAL_DEBUG(TRACE, "Going back to userland.\r\n");
 
     extern void resumeAsm(user_ctx_t*);
+    pipcallStatLeave();
     resumeAsm(&ctxToResume);
 
     ASSERT(0);
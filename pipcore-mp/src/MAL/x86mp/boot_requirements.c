@@ -39,6 +39,7 @@
 #include <stdint.h>
 #include "structures.h"
 #include "mal.h"
+#include "physmap.h"
 #include "debug.h"
 #include "libc.h"
 #include "ial.h"
@@ -52,12 +53,16 @@ void activate(uintptr_t dir)
 {
   	// Set CR3 to the address of our Page Directory
   	page_directory_t* d = (page_directory_t*)dir;
+	uint32_t cr0;
 	asm volatile("mov %0, %%cr3"
 		 :
 		 : "r"(dir));
 
-	// Switch on paging
-	enable_paging();
+	// Switch on paging, unless already on : a CR0 write serializes, and
+	// toggling CR0.PG would drop the kernel's global TLB entries
+	asm volatile("mov %%cr0, %0": "=r"(cr0));
+	if(!(cr0 & 0x80000000))
+		enable_paging();
 	
 }
 
@@ -137,14 +142,12 @@ void cleanPageEntry(uintptr_t table, uint32_t index){
  */
 uint32_t readIndex(uintptr_t table, uint32_t index)
 {
-	/* We're in kernel : we can disable paging */
-	disable_paging();
+	PHYS_BEGIN();
 	
 	/* Now we got a fresh, cool, nice pointer, return its value */
-	uint32_t val = ((uint32_t*)table)[index];
+	uint32_t val = *PHYS_ENTRY(table, index);
 	
-    /* Re-enable paging */
-	enable_paging();
+	PHYS_END();
 	
 	return val;
 }
@@ -158,16 +161,14 @@ uint32_t readIndex(uintptr_t table, uint32_t index)
  */
 void writeIndex(uintptr_t table, uint32_t index, uint32_t addr)
 {
-	/* Disable paging */
-	disable_paging();
+	PHYS_BEGIN();
 	
 	/* Just in case we're given bullshit, zero the potential flags. */
 	uint32_t val = (uint32_t)addr;
 	
-	((uint32_t*)table)[index] = val /* | curFlags */;
+	*PHYS_ENTRY(table, index) = val /* | curFlags */;
 	
-	/* Enable paging */
-	enable_paging();
+	PHYS_END();
 	
 	return;
 }
@@ -191,9 +192,9 @@ uintptr_t toAddr(uint32_t input)
  */
 void cleanPage(uintptr_t paddr)
 {
-	disable_paging();
-	memset((uint32_t*)paddr, 0x00000000, PAGE_SIZE);
-	enable_paging();
+	PHYS_BEGIN();
+	memset(PHYS_ENTRY(paddr, 0), 0x00000000, PAGE_SIZE);
+	PHYS_END();
 }
 
 /**
@@ -208,21 +209,20 @@ void cleanPage(uintptr_t paddr)
  */
 uint32_t applyRights(uintptr_t table, uint32_t index, uint32_t read, uint32_t write, uint32_t execute)
 {
-	disable_paging();
-	
 	// First check is we can do this
 	uint32_t checkright = checkRights(read, write, execute);
 	if(checkright == 0)
 		return 0;
 	
+	PHYS_BEGIN();
+	
 	// Find the entry
-	uintptr_t dest = table | ((uintptr_t)index * sizeof(uint32_t));
-	page_table_entry_t* entry = (page_table_entry_t*)dest;
+	page_table_entry_t* entry = (page_table_entry_t*)PHYS_ENTRY(table, index);
 	
 	// Change the RW bit
 	entry->rw = write;
 	
-	enable_paging();
+	PHYS_END();
 	
 	return 1;
 }
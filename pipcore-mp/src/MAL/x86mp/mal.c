@@ -39,6 +39,7 @@
 #include <stdint.h>
 #include "mal.h"
 #include "structures.h"
+#include "physmap.h"
 #include "debug.h"
 
 uint32_t current_partition[16]; /* Current partition's CR3 */
@@ -73,6 +74,71 @@ void disable_paging()
 	asm volatile("mov %0, %%cr0":: "r"(cr0));
 }
 
+#ifdef PIP_PHYSMAP
+/* Window pages, one per core, and a page through which the kernel page table
+ * sees itself. Both live in the kernel's own page table, shared by every
+ * partition, and stay supervisor-only. */
+static uint8_t physmapSlots[16][PAGE_SIZE] __attribute__((aligned(PAGE_SIZE)));
+static uint32_t physmapTable[1024] __attribute__((aligned(PAGE_SIZE)));
+
+/*!
+ * \fn void physmapInit(uint32_t dir)
+ * \brief Maps the kernel page table of the given directory over physmapTable
+ * \param dir The kernel page directory, paging being still disabled
+ */
+void physmapInit(uint32_t dir)
+{
+	uint32_t kpt = readTableVirtual(dir, kernelIndex());
+	page_table_entry_t* entry = (page_table_entry_t*)kpt + getIndexOfAddr((uint32_t)physmapTable, 0);
+
+	if(getIndexOfAddr((uint32_t)physmapSlots, 1) != kernelIndex()
+	   || getIndexOfAddr((uint32_t)physmapTable, 1) != kernelIndex())
+	{
+		DEBUG(CRITICAL, "Physmap window is out of the kernel page table, halting.\n");
+		for(;;);
+	}
+
+	entry->frame = kpt >> 12;
+	entry->present = 1;
+	entry->rw = 1;
+	entry->user = 0;
+}
+
+/*!
+ * \fn uint32_t* physmapAddr(uint32_t paddr)
+ * \brief Gets a kernel pointer to the given physical address through the core's window
+ * \param paddr The physical address
+ * \return A pointer valid until the next physmapAddr call on this core
+ */
+uint32_t* physmapAddr(uint32_t paddr)
+{
+	uint32_t cr0, tr;
+	asm volatile("mov %%cr0, %0": "=r"(cr0));
+
+	/* Early boot : memory is still flat */
+	if(!(cr0 & 0x80000000))
+		return (uint32_t*)paddr;
+
+	/* TR holds the core's own TSS selector, consecutive across cores, which
+	 * is much cheaper to get than the CPUID behind coreId() */
+	asm volatile("str %0": "=r"(tr));
+	uint32_t slot = (uint32_t)physmapSlots[(tr >> 3) & 0xF];
+	uint32_t* pte = &physmapTable[getIndexOfAddr(slot, 0)];
+	uint32_t frame = paddr & 0xFFFFF000;
+
+	/* The accessed and dirty bits may have been set behind our back. The
+	 * window is global like the rest of the kernel, so that it survives CR3
+	 * switches : invlpg drops global entries as well. */
+	if((*pte & 0xFFFFF001) != (frame | 0x1))
+	{
+		*pte = frame | 0x103;
+		asm volatile("invlpg (%0)":: "r"(slot): "memory");
+	}
+
+	return (uint32_t*)(slot | (paddr & 0xFFF));
+}
+#endif
+
 /*!
  * \fn void writePhysical(uint32_t table, uint32_t index, uint32_t addr)
  * \brief Stores the given address into the given indirection table, at the given index, with physical addresses
@@ -82,14 +148,12 @@ void disable_paging()
  */
 void writePhysical(uint32_t table, uint32_t index, uint32_t val)
 {
-	/* Disable paging */
-	disable_paging();
+	PHYS_BEGIN();
 	
 	/* Get the destination address */
-    ((uint32_t*)table)[index] = val;
+	*PHYS_ENTRY(table, index) = val;
 	
-	/* Enable paging */
-	enable_paging();
+	PHYS_END();
 	
 	return;
 }
@@ -103,17 +167,15 @@ void writePhysical(uint32_t table, uint32_t index, uint32_t val)
  */
 uint32_t readPhysicalNoFlags(uint32_t table, uint32_t index)
 {
-	/* We're in kernel : we can disable paging */
-	disable_paging();
+	PHYS_BEGIN();
 	
 	/* We're page-aligned : zero the flags */
 	uint32_t mask = 0xFFFFF000;
 	
 	/* Now we got a fresh, cool, nice pointer, return its value */
-	uint32_t val = ((uint32_t*)table)[index];
+	uint32_t val = *PHYS_ENTRY(table, index);
 	
-	/* Re-enable paging */
-	enable_paging();
+	PHYS_END();
 	
 	return val & 0xFFFFF000;
 }
@@ -164,10 +226,10 @@ uint32_t getIndexOfAddr(uint32_t addr, uint32_t index)
  */
 uint32_t readAccessible(uint32_t table, uint32_t index)
 {
-	disable_paging();
+	PHYS_BEGIN();
 	
 	/* Get value */
-	uint32_t val = ((uint32_t*)table)[index];
+	uint32_t val = *PHYS_ENTRY(table, index);
 	
 	/* Cast it into a page_table_entry_t structure */
 	page_table_entry_t* entry = (page_table_entry_t*)&val;
@@ -175,7 +237,7 @@ uint32_t readAccessible(uint32_t table, uint32_t index)
 	/* Now return the accessible flag */
 	uint32_t ret = entry->user;
 	
-	enable_paging();
+	PHYS_END();
 	
 	return ret;
 }
@@ -189,18 +251,15 @@ uint32_t readAccessible(uint32_t table, uint32_t index)
  */
 void writeAccessible(uint32_t table, uint32_t index, uint32_t value)
 {
-	disable_paging();
-	
-	/* Get destination */
-	uint32_t dest = table | (index * sizeof(uint32_t));
+	PHYS_BEGIN();
 	
-	/* Cast it into a page_table_entry_t structure */
-	page_table_entry_t* entry = (page_table_entry_t*)dest;
+	/* Cast the destination into a page_table_entry_t structure */
+	page_table_entry_t* entry = (page_table_entry_t*)PHYS_ENTRY(table, index);
 	
 	/* Write the flag */
 	entry->user = value;
 	
-	enable_paging();
+	PHYS_END();
 	
 	/* Return so we avoid the warning */
 	return;
@@ -224,11 +283,13 @@ updateCurPartition (uint32_t descriptor)
 {
 	extern uint32_t pcid_enabled;
 	current_partition[coreId()] = descriptor;
-	if(readPhysical(descriptor, 12) == 0x0 && pcid_enabled)
+	/* Only look at the PID slot when PCIDs are in use : it is a physical read */
+	if(pcid_enabled && readPhysical(descriptor, 12) == 0x0)
 	{
-		writePhysical(descriptor, 12, next_pid);
-		DEBUG(TRACE, "Registered partition descriptor %x as PID %d.\n", descriptor, next_pid);
-		next_pid++;
+		/* Cores running separate partition trees may get here concurrently */
+		uint32_t pid = __sync_fetch_and_add(&next_pid, 1);
+		writePhysical(descriptor, 12, pid);
+		DEBUG(TRACE, "Registered partition descriptor %x as PID %d.\n", descriptor, pid);
 	}
 }
 
@@ -260,17 +321,17 @@ updateRootPartition(uint32_t partition)
  */
 uint32_t readPresent(uint32_t table, uint32_t index)
 {
-	disable_paging();
+	PHYS_BEGIN();
 	
 	/* Get value */
-	uint32_t val = ((uint32_t*)table)[index];
+	uint32_t val = *PHYS_ENTRY(table, index);
 	
 	/* Cast it into a page_table_entry_t structure */
 	page_table_entry_t* entry = (page_table_entry_t*)&val;
 	
 	uint32_t res = entry->present;
 	
-	enable_paging();
+	PHYS_END();
 	
 	/* Now return the present flag */
 	return res;
@@ -285,18 +346,15 @@ uint32_t readPresent(uint32_t table, uint32_t index)
  */
 void writePresent(uint32_t table, uint32_t index, uint32_t value)
 {
-	disable_paging();
+	PHYS_BEGIN();
 	
-	/* Get destination */
-	uint32_t dest = table | (index * sizeof(uint32_t));
-	
-	/* Cast it into a page_table_entry_t structure */
-	page_table_entry_t* entry = (page_table_entry_t*)dest;
+	/* Cast the destination into a page_table_entry_t structure */
+	page_table_entry_t* entry = (page_table_entry_t*)PHYS_ENTRY(table, index);
 	
 	/* Write the flag */
 	entry->present = value;
 	
-	enable_paging();
+	PHYS_END();
 	
 	/* Return so we avoid the warning */
 	return;
@@ -312,17 +370,17 @@ void writePresent(uint32_t table, uint32_t index, uint32_t value)
  */
 void writePDflag(uint32_t table, uint32_t index, uint32_t value)
 {
-	disable_paging();
+	PHYS_BEGIN();
 	
-	uint32_t curval = ((uint32_t*)table)[index];
-	uint32_t curAddr = (uint32_t)curval & 0xFFFFFFFE;
+	uint32_t* entry = PHYS_ENTRY(table, index);
+	uint32_t curAddr = *entry & 0xFFFFFFFE;
 
 	if(value == 1)
-		((uint32_t*)table)[index] = curAddr | 0x00000001;
+		*entry = curAddr | 0x00000001;
 	else
-		((uint32_t*)table)[index] = curAddr;
+		*entry = curAddr;
 	
-	enable_paging();
+	PHYS_END();
 	
 	return;
 }
@@ -336,25 +394,23 @@ void writePDflag(uint32_t table, uint32_t index, uint32_t value)
  */
 uint32_t readPDflag(uint32_t table, uint32_t index)
 {
-	disable_paging();
+	PHYS_BEGIN();
 	
-	uint32_t curval = ((uint32_t*)table)[index];
+	uint32_t curval = *PHYS_ENTRY(table, index);
 	
-	enable_paging();
+	PHYS_END();
 	
 	return (curval & 0x00000001);
 }
 
 uint32_t readPhysical(uint32_t table, uint32_t index)
 {
-	/* We're in kernel : we can disable paging */
-	disable_paging();
+	PHYS_BEGIN();
 	
 	/* Now we got a fresh, cool, nice pointer, return its value */
-	uint32_t val = ((uint32_t*)table)[index];
+	uint32_t val = *PHYS_ENTRY(table, index);
 	
-	/* Re-enable paging */
-	enable_paging();
+	PHYS_END();
 	
 	return val;
 }
@@ -362,16 +418,15 @@ uint32_t readPhysical(uint32_t table, uint32_t index)
 
 void writePhysicalNoFlags(uint32_t table, uint32_t index, uint32_t addr)
 {
-	/* Disable paging */
-	disable_paging();
+	PHYS_BEGIN();
 	
 	/* Just in case we're given bullshit, zero the potential flags. */
 	uint32_t val = (uint32_t)addr & ~0xfff;
+	uint32_t* entry = PHYS_ENTRY(table, index);
 	
-	((uint32_t*)table)[index] = (((uint32_t*)table)[index]&0xfff)|val;
+	*entry = (*entry & 0xfff) | val;
 	
-	/* Enable paging */
-	enable_paging();
+	PHYS_END();
 	
 	return;
 }
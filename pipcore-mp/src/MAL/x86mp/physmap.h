@@ -0,0 +1,71 @@
+/*******************************************************************************/
+/*  © Université Lille 1, The Pip Development Team (2015-2017)                 */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/**
+ * \file physmap.h
+ * \brief x86 kernel access to physical memory
+ *
+ * By default the MAL reaches physical memory by clearing CR0.PG around each
+ * access. Building with PIP_PHYSMAP defined gives each core a kernel-only
+ * window page in the kernel page table instead : the window is retargeted
+ * with a PTE write and an invlpg when the frame changes, and accesses are
+ * plain loads and stores.
+ *
+ * Clearing CR0.PG also flushes the global TLB entries of the kernel, so only
+ * PIP_PHYSMAP builds keep them across partition switches.
+ */
+
+#ifndef __PHYSMAP__
+#define __PHYSMAP__
+
+#include <stdint.h>
+#include "mal.h"
+
+#ifdef PIP_PHYSMAP
+
+void physmapInit(uint32_t dir); //!< Maps the kernel page table into itself, paging must be off
+uint32_t* physmapAddr(uint32_t paddr); //!< Gets a kernel pointer to the given physical address
+
+#define PHYS_BEGIN()
+#define PHYS_END()
+#define PHYS_ENTRY(table, index) physmapAddr((uint32_t)(table) + (index) * sizeof(uint32_t))
+
+#else
+
+#define PHYS_BEGIN()                disable_paging()
+#define PHYS_END()                  enable_paging()
+#define PHYS_ENTRY(table, index)    ((uint32_t*)(table) + (index))
+
+#endif
+
+#endif
@@ -52,12 +52,16 @@ void activate(uintptr_t dir)
 {
   	// Set CR3 to the address of our Page Directory
   	page_directory_t* d = (page_directory_t*)dir;
+	uint32_t cr0;
 	asm volatile("mov %0, %%cr3"
 		 :
 		 : "r"(dir));
 
-	// Switch on paging
-	enable_paging();
+	// Switch on paging, unless already on : a CR0 write serializes, and
+	// toggling CR0.PG would drop the kernel's global TLB entries
+	asm volatile("mov %%cr0, %0": "=r"(cr0));
+	if(!(cr0 & 0x80000000))
+		enable_paging();
 	
 }
 
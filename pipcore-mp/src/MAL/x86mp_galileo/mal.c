@@ -226,9 +226,10 @@ updateCurPartition (uint32_t descriptor)
 	current_partition[coreId()] = descriptor;
 	if(readPhysical(descriptor, 12) == 0x0 && pcid_enabled)
 	{
-		writePhysical(descriptor, 12, next_pid);
-		DEBUG(TRACE, "Registered partition descriptor %x as PID %d.\r\n", descriptor, next_pid);
-		next_pid++;
+		/* Cores running separate partition trees may get here concurrently */
+		uint32_t pid = __sync_fetch_and_add(&next_pid, 1);
+		writePhysical(descriptor, 12, pid);
+		DEBUG(TRACE, "Registered partition descriptor %x as PID %d.\r\n", descriptor, pid);
 	}
 }
 
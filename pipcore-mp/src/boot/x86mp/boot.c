@@ -45,6 +45,7 @@
 #include "ial.h"
 #include "git.h"
 #include "fpinfo.h"
+#include "timepage.h"
 
 /* Some debugging output if PIPDEBUG is set */
 #include "debug.h"
@@ -271,6 +272,9 @@ int c_main(struct multiboot *mbootPtr)
     MP_LOCK(lock_cores);
     MP_LOCK(mmu_init_spinlock);
 
+    /* Calibrate the TSC before APs add noise */
+    timepageInit();
+
     /* Bootup APs. */
     DEBUG(CRITICAL, "-> Initializing SMP.\n");
     init_mp();
@@ -53,16 +53,25 @@ tssFlush:
 	ltr ax
 	ret
 
-%macro CG_GLUE_NOARG 1
+%macro CG_GLUE_NOARG 2
 extern %1
 global cg_%1
 cg_%1:
 	cli
+	push dword %2
+	call pipcallStatEnter
+	add esp, 4
  	call %1
+	push eax
+	call pipcallStatLeave
+	pop eax
 	sti
 	retf
 %endmacro
 
+; The last macro argument is the PIPCALL_* number of the call (syscall.h),
+; under which pipstat.c files its counters
+
 ; Callgate stack layout: 
 ;	usereip
 ;	cs
@@ -71,9 +80,11 @@ cg_%1:
 ;	ss
 extern api_lock
 extern api_unlock
+extern pipcallStatEnter
+extern pipcallStatLeave
 extern api_ptr
 extern dumpStuff
-%macro CG_GLUE 2
+%macro CG_GLUE 3
 extern %1
 global cg_%1
 cg_%1:
@@ -83,9 +94,13 @@ cg_%1:
 	pop edi
 ; call pip function
 	call api_lock
+	push dword %3
+	call pipcallStatEnter
+	add esp, 4
 	call %1
 ; keep api call result code
 	push eax
+	call pipcallStatLeave
 	call api_unlock
 	pop eax
 ; restore eip:cs
@@ -96,7 +111,31 @@ cg_%1:
 	retf (4*%2)
 %endmacro
 
-%macro CG_GLUE_CTX 2
+; Read-only calls, run without taking the pipcall lock
+%macro CG_GLUE_NOLOCK 3
+extern %1
+global cg_%1
+cg_%1:
+	cli
+; save resume eip:cs;
+    pop esi
+	pop edi
+	push dword %3
+	call pipcallStatEnter
+	add esp, 4
+	call %1
+	push eax
+	call pipcallStatLeave
+	pop eax
+; restore eip:cs
+	push edi
+	push esi
+; back to userland
+	sti
+	retf (4*%2)
+%endmacro
+
+%macro CG_GLUE_CTX 3
 extern %1
 global cg_%1
 cg_%1:
@@ -116,8 +155,12 @@ cg_%1:
 	push dword [0x24+esp+8+4*(%2-1)]
 %endrep
 	call api_lock
+	push dword %3
+	call pipcallStatEnter
+	add esp, 4
 	call %1
 	push eax
+	call pipcallStatLeave
 	call api_unlock
 	pop eax
 	add esp, 0x24+4*%2
@@ -130,25 +173,31 @@ cg_%1:
 ; These functions might trigger a call to dispatchGlue
 ; therefore they need a reference to calling context (regs + eip)
 ; in order to save it if needed
-CG_GLUE_CTX outbGlue		, 2
-CG_GLUE_CTX inbGlue		, 1
-CG_GLUE_CTX outwGlue		, 2
-CG_GLUE_CTX inwGlue		, 1
-CG_GLUE_CTX outlGlue 		, 2
-CG_GLUE_CTX inlGlue 		, 1
-CG_GLUE_CTX outaddrlGlue 	, 2
-CG_GLUE_CTX dispatchGlue	, 5
+CG_GLUE_CTX outbGlue		, 2, 12
+CG_GLUE_CTX inbGlue		, 1, 13
+CG_GLUE_CTX outwGlue		, 2, 14
+CG_GLUE_CTX inwGlue		, 1, 15
+CG_GLUE_CTX outlGlue 		, 2, 16
+CG_GLUE_CTX inlGlue 		, 1, 17
+CG_GLUE_CTX outaddrlGlue 	, 2, 18
+CG_GLUE_CTX dispatchGlue	, 5, 4
 
 ; Those ones won't trigger a fault in caller
-CG_GLUE createPartition		, 5
-CG_GLUE countToMap  		, 2
-CG_GLUE prepare 			, 4
-CG_GLUE addVAddr    		, 6
-CG_GLUE resume		    	, 2
-CG_GLUE removeVAddr 		, 2
-CG_GLUE	mappedInChild   	, 1
-CG_GLUE	deletePartition 	, 1
-CG_GLUE	collect 			, 2
-CG_GLUE smpRequest          , 2
+CG_GLUE createPartition		, 5, 0
+CG_GLUE_NOLOCK countToMap	, 2, 1
+CG_GLUE prepare 			, 4, 2
+CG_GLUE addVAddr    		, 6, 3
+CG_GLUE resume		    	, 2, 6
+CG_GLUE removeVAddrGlue 		, 2, 7
+CG_GLUE_NOLOCK mappedInChild	, 1, 8
+CG_GLUE	deletePartitionGlue 	, 1, 9
+CG_GLUE	collectGlue 			, 2, 10
+CG_GLUE_NOLOCK smpRequest	, 2, 11
+CG_GLUE mapRangeGlue        , 5, 20
+CG_GLUE unmapRangeGlue      , 3, 21
+CG_GLUE traceDrainGlue       , 3, 22
+CG_GLUE irqRouteGlue        , 2, 23
+CG_GLUE ioBatchGlue         , 2, 24
+CG_GLUE ioGrantGlue         , 3, 25
 
-CG_GLUE_NOARG  timerGlue
+CG_GLUE_NOARG  timerGlue, 5
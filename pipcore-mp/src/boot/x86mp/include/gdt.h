@@ -66,6 +66,8 @@ struct gdt_ptr
     unsigned int base; //!< Base address
 } __attribute__((packed));
 
+#define IOMAP_BYTES	(0x10000 / 8) //!< One bit per IO port
+
 /**
  * \struct tss_entry_struct
  * \brief Task State Segment entry structure
@@ -97,7 +99,9 @@ struct tss_entry_struct {
 	uint32_t gs; //!< Segment selector GS
 	uint32_t ldt; //!< Pointer to the LDT (unused here)
 	uint16_t trap; //!< Admiral Ackbar : "It's a trap!"
-	uint16_t iomap_base; //!< IOMMU base
+	uint16_t iomap_base; //!< IO permission bitmap offset
+	uint8_t iomap[IOMAP_BYTES]; //!< IO permission bitmap, a clear bit lets userland use the port
+	uint8_t iomap_end; //!< Must stay 0xFF
 } __attribute__((packed));
 
 typedef struct tss_entry_struct tss_entry_t; //!< TSS entry for kernel-mode switch
@@ -128,6 +132,26 @@ extern void tssFlush();
 
 void setKernelStack(uint32_t stack);
 
+extern uint32_t tssBase; //!< GDT index of core 0's TSS, the other cores follow
+extern tss_entry_t tssEntry[16]; //!< Per-core TSS
+
+/**
+ * \fn static inline uint32_t tssCoreId(void)
+ * \brief Gets the running core from its TSS selector, much cheaper than the CPUID behind coreId()
+ * \return The core index, out of range before the core loaded its TSS
+ */
+static inline uint32_t tssCoreId(void)
+{
+	uint32_t tr;
+	asm volatile("str %0": "=r"(tr));
+	return (tr >> 3) - tssBase;
+}
+
+/* Pipcall locking */
+void api_lock();
+void api_unlock();
+uint32_t api_lock_stat(uint32_t contended);
+
 /* Farcalls to API methods */
 extern bool createPartitionGlue(uint32_t ref, uint32_t pd, uint32_t sh1, uint32_t sh2, uint32_t sh3) ;
 
@@ -0,0 +1,61 @@
+/*******************************************************************************/
+/*  © Université Lille 1, The Pip Development Team (2015-2017)                 */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/**
+ * \file pipstat.h
+ * \brief Per-core pipcall counters and latency histograms
+ *
+ * Every SYSENTER call and callgate is counted on the core running it, and
+ * its duration in TSC cycles lands in a log2 histogram : bucket b holds the
+ * calls that took [2^b, 2^(b+1)) cycles. Dispatch and resume switch to
+ * another partition instead of returning : they are timed up to the switch.
+ */
+
+#ifndef __PIPSTAT__
+#define __PIPSTAT__
+
+#include <stdint.h>
+#include "syscall.h"
+
+#define PIPSTAT_CORES		16
+#define PIPSTAT_BUCKETS		32
+
+/* smpRequest parameter of SMP_REQUEST_PIPCALLSTAT */
+#define PIPSTAT_COUNT		0xFF //!< Bucket number that reads the call count
+#define PIPSTAT_QUERY(core, call, bucket) (((core) << 16) | ((call) << 8) | (bucket))
+
+void pipcallStatEnter(uint32_t call); //!< Starts timing a pipcall on this core
+void pipcallStatLeave(void); //!< Ends the pipcall being timed on this core, if any
+uint32_t pipcallStatQuery(uint32_t query); //!< Reads a counter from a PIPSTAT_QUERY
+
+#endif
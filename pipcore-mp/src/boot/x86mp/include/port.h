@@ -58,4 +58,40 @@ uint32_t cg_inw(uint32_t port); //!< Inw callgate method
 void cg_outl(uint32_t port, uint32_t value); //!< Outl callgate method
 void cg_outaddrl(uint32_t port, uint32_t value); //!< Outaddrl callgate method
 uint32_t cg_inl(uint32_t port); //!< Inl callgate method
+
+/* Batched IO, see ioBatchGlue */
+#define IO_OP_OUTB		0
+#define IO_OP_OUTW		1
+#define IO_OP_OUTL		2
+#define IO_OP_INB		3 //!< value receives the read value
+#define IO_OP_INW		4
+#define IO_OP_INL		5
+#define IO_OP_OUTSB		6 //!< rep outs, value is the buffer address, count its element count
+#define IO_OP_OUTSW		7
+#define IO_OP_OUTSL		8
+#define IO_OP_INSB		9 //!< rep ins, value is the buffer address, count its element count
+#define IO_OP_INSW		10
+#define IO_OP_INSL		11
+
+#define IO_BATCH_MAX	256 //!< Descriptors per ioBatch call
+
+/**
+ * \struct io_op
+ * \brief One IO access of an ioBatch call, as laid out by the partition
+ */
+struct io_op {
+	uint32_t op;	//!< IO_OP_* operation
+	uint32_t port;	//!< IO port
+	uint32_t value;	//!< Value to write, read value, or buffer address for string operations
+	uint32_t count;	//!< String operations element count
+};
+
+uint32_t ioBatchGlue(uint32_t ops, uint32_t count); //!< Runs an array of IO accesses
+uint32_t userBufferMapped(uint32_t buffer, uint32_t size, uint32_t writable); //!< Checks the current partition may access a buffer
+
+/* IO port grants */
+void ioBitmapSwitch(uint32_t partition); //!< Loads the granted ports of the activated partition
+uint32_t ioGrantsBelow(uint32_t partition); //!< Lists the grants of a partition and its descendants
+void ioGrantDrop(uint32_t slots); //!< Frees the grants listed by ioGrantsBelow
+uint32_t ioGrantGlue(uint32_t child, uint32_t port, uint32_t count); //!< Grants IO ports to a child
 #endif
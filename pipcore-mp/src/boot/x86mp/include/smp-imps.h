@@ -224,6 +224,7 @@ extern int send_ipi(unsigned int dst, unsigned int v);
    (*((volatile unsigned *) (imps_lapic_addr+(x))) = (y))
 
 #define SEND_NMIPI(a)   { disable_paging(); send_ipi(a, LAPIC_ICR_DM_NMI); enable_paging(); }
+#define SEND_VECIPI(a, v)   { disable_paging(); send_ipi(a, (v)); enable_paging(); }
 
 #endif  /* !_SMP_IMPS_H */
 
@@ -3,6 +3,36 @@
 
 #include <stdint.h>
 
+/* SYSENTER call numbers, also used to file callgate statistics */
+#define PIPCALL_CREATEPARTITION	0
+#define PIPCALL_COUNTTOMAP	1
+#define PIPCALL_PREPARE		2
+#define PIPCALL_ADDVADDR	3
+#define PIPCALL_DISPATCH	4
+#define PIPCALL_TIMER		5
+#define PIPCALL_RESUME		6
+#define PIPCALL_REMOVEVADDR	7
+#define PIPCALL_MAPPEDINCHILD	8
+#define PIPCALL_DELETEPARTITION	9
+#define PIPCALL_COLLECT		10
+#define PIPCALL_SMPREQUEST	11
+#define PIPCALL_OUTB		12
+#define PIPCALL_INB		13
+#define PIPCALL_OUTW		14
+#define PIPCALL_INW		15
+#define PIPCALL_OUTL		16
+#define PIPCALL_INL		17
+#define PIPCALL_OUTADDRL	18
+#define PIPCALL_PUTS		19
+#define PIPCALL_MAPRANGE	20
+#define PIPCALL_UNMAPRANGE	21
+#define PIPCALL_TRACEDRAIN	22
+#define PIPCALL_IRQROUTE	23
+#define PIPCALL_IOBATCH		24
+#define PIPCALL_IOGRANT		25
+
+#define PIPCALL_COUNT		26
+
 void init_sysenter(uint32_t cid);
 
 #endif
@@ -0,0 +1,66 @@
+/*******************************************************************************/
+/*  © Université Lille 1, The Pip Development Team (2015-2017)                 */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/**
+ * \file timepage.h
+ * \brief Read-only time page shared with every partition
+ *
+ * The page lives in the kernel page table, which every partition maps, and is
+ * the only page of it that userland may read. It gives the TSC frequency and
+ * the TSC value at boot, so that partitions timestamp with RDTSC instead of
+ * the timer callgate. Cores share the BSP's TSC, so there is a single base :
+ * reading the time needs no core index, hence no trapping instruction.
+ */
+
+#ifndef __TIMEPAGE__
+#define __TIMEPAGE__
+
+#include <stdint.h>
+
+#define TIMEPAGE_MAGIC		0x54494D45 /* "TIME" */
+
+/**
+ * \struct timepage
+ * \brief Layout of the time page, this is the ABI
+ */
+struct timepage {
+	uint32_t magic; //!< TIMEPAGE_MAGIC once the page is valid
+	uint32_t tscKhz; //!< TSC frequency, in kHz
+	uint64_t tscBase; //!< TSC value at boot
+} __attribute__((packed));
+
+void timepageInit(void); //!< Calibrates the TSC and publishes the page, BSP only
+void timepageMap(uint32_t dir); //!< Makes the page user-readable in a kernel page directory, paging must be off
+uint32_t timepageAddr(void); //!< Address of the page, the same in every partition
+
+#endif
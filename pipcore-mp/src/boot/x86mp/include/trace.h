@@ -0,0 +1,80 @@
+/*******************************************************************************/
+/*  © Université Lille 1, The Pip Development Team (2015-2017)                 */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/**
+ * \file trace.h
+ * \brief Per-core binary trace rings
+ *
+ * Hot paths record fixed-size events into a ring owned by the running core,
+ * with no formatting and no lock. The root partition copies records out with
+ * the traceDrain pipcall and decodes them offline. Building with TRACE=0
+ * compiles the events out.
+ */
+
+#ifndef __TRACE__
+#define __TRACE__
+
+#include <stdint.h>
+
+#define TRACE_CORES		16
+#define TRACE_RING_SIZE		128 //!< Records per core, a power of two
+
+/* Event identifiers, the records layout and these values are the ABI */
+#define TRACE_EV_LOST		0 //!< args[0] records overwritten before being drained
+#define TRACE_EV_INTERRUPT	1 //!< int_no, eip, current partition
+#define TRACE_EV_DISPATCH	2 //!< partition, vint, caller, data1
+#define TRACE_EV_IPDISPATCH	3 //!< partition, vint, target core, data1
+#define TRACE_EV_RESUME		4 //!< descriptor, partition, pipflags
+
+/**
+ * \struct trace_record
+ * \brief One trace event, 32 bytes
+ */
+struct trace_record {
+	volatile uint32_t seq; //!< Ring index + 1 once the record is complete, 0 while written
+	uint16_t event; //!< TRACE_EV_* identifier
+	uint16_t core; //!< Core that recorded the event
+	uint64_t tsc; //!< Time stamp counter at record time
+	uint32_t args[4]; //!< Event arguments
+};
+
+#ifdef PIP_TRACE
+#define TRACE_EVENT(e, a, b, c, d) traceEvent((e), (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d))
+#else
+#define TRACE_EVENT(...)
+#endif
+
+void traceEvent(uint32_t event, uint32_t a, uint32_t b, uint32_t c, uint32_t d);
+uint32_t traceDrainGlue(uint32_t core, uint32_t buffer, uint32_t count);
+
+#endif
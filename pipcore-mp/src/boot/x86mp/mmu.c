@@ -42,7 +42,9 @@
 #include "debug.h"
 #include "mal.h"
 #include "structures.h"
+#include "physmap.h"
 #include "fpinfo.h"
+#include "timepage.h"
 #include "git.h"
 #include "hdef.h"
 #include "mp.h"
@@ -296,6 +298,10 @@ void dumpMmap(uint32_t *mmap_ptr, uint32_t len)
 /**
  * \fn void mark_kernel_global()
  * \brief Marks the whole kernel area as global, preventing TLB invalidations
+ * \note Only the kernel page table is shared by every partition. Pages mapped
+ *       elsewhere, such as the fpinfo page or a partition's VIDT, must stay
+ *       non-global or another partition could reach them through a stale entry.
+ *       Global entries are only dropped by invlpg or a CR4.PGE/CR0.PG toggle.
  */
 void mark_kernel_global()
 {
@@ -381,6 +387,14 @@ uint32_t initMmu()
 		}
 	}
 	
+#ifdef PIP_PHYSMAP
+	/* Physical accesses go through the kernel page table from now on */
+	physmapInit((uint32_t)kernelDirectories[coreId()]);
+#endif
+
+	/* Partitions read the time page through the kernel page table */
+	timepageMap((uint32_t)kernelDirectories[coreId()]);
+
 	mark_kernel_global();
 	
 	/* First, pseudo-prepare kernel directory, removing potential page tables from free page list */
@@ -535,9 +549,49 @@ void fillMmu(uint32_t begin)
     DEBUG(CRITICAL, "Done.\n");
 }
 
+#ifdef PIP_PHYSMAP
+/* Identity-mapped kernel frames the physmap self-test aims the window at */
+static volatile uint32_t physmapProbe[2][PAGE_SIZE / sizeof(uint32_t)] __attribute__((aligned(PAGE_SIZE)));
+
+/**
+ * \fn static void physmapSelfTest()
+ * \brief Checks that retargeting the global physmap window is seen at once
+ * \note The window entry is global and CR4.PGE is on, so only the invlpg in
+ *       physmapAddr drops its old translation. A tag written through the
+ *       window has to land in the right frame, seen through the identity
+ *       mapping, and each frame has to be read back once the window moved.
+ *       Cores run this one at a time, under mmu_init_spinlock.
+ */
+static void physmapSelfTest()
+{
+	uint32_t tag = 0x9A6E0000 | coreId();
+
+	physmapProbe[0][0] = 0;
+	physmapProbe[1][0] = 0;
+
+	/* Load the window's TLB entry on the first frame, then move it */
+	*(volatile uint32_t*)physmapAddr((uint32_t)physmapProbe[0]) = tag;
+	*(volatile uint32_t*)physmapAddr((uint32_t)physmapProbe[1]) = ~tag;
+
+	if(physmapProbe[0][0] != tag || physmapProbe[1][0] != ~tag
+	   || *(volatile uint32_t*)physmapAddr((uint32_t)physmapProbe[0]) != tag
+	   || *(volatile uint32_t*)physmapAddr((uint32_t)physmapProbe[1]) != ~tag)
+	{
+		DEBUG(CRITICAL, "Physmap window kept a stale global TLB entry on core %d, halting.\n", coreId());
+		for(;;);
+	}
+	DEBUG(CRITICAL, "Physmap window retargeting checked on core %d.\n", coreId());
+}
+#endif
+
 void coreEnableMmu()
 {
     if(IS_MPMT)
         activate((uint32_t)kernelDirectories[0]);
     else activate((uint32_t)kernelDirectories[coreId()]);
+
+#ifdef PIP_PHYSMAP
+    /* Paging and CR4.PGE are on : global-page invalidation can be checked */
+    physmapSelfTest();
+#endif
 }
@@ -9,6 +9,10 @@
 #include <stdint.h>
 
 #include "debug.h"
+#include "pipstat.h"
+#include "timepage.h"
+#include "port.h"
+#include "gdt.h"
 
 #define UDELAY(x) delay_loop(100 * x) 
 
@@ -205,6 +209,11 @@ void init_mp_legacy()
 
 #define SMP_REQUEST_COREID      0
 #define SMP_REQUEST_CORECOUNT   1
+#define SMP_REQUEST_LOCKTAKEN   2
+#define SMP_REQUEST_LOCKSPUN    3
+#define SMP_REQUEST_PIPCALLSTAT 4
+#define SMP_REQUEST_TIMEPAGE    5
+#define SMP_REQUEST_MAPPED      6
 
 /* Generic callgate for SMP requests (core id, core count etc) */
 uint32_t smpRequest(uint32_t requestId, uint32_t parameter)
@@ -217,6 +226,21 @@ uint32_t smpRequest(uint32_t requestId, uint32_t parameter)
         case SMP_REQUEST_CORECOUNT:
             return coreCount();
             break;
+        case SMP_REQUEST_LOCKTAKEN:
+            return api_lock_stat(0);
+            break;
+        case SMP_REQUEST_LOCKSPUN:
+            return api_lock_stat(1);
+            break;
+        case SMP_REQUEST_PIPCALLSTAT:
+            return pipcallStatQuery(parameter);
+            break;
+        case SMP_REQUEST_TIMEPAGE:
+            return timepageAddr();
+            break;
+        case SMP_REQUEST_MAPPED:
+            return userBufferMapped(parameter, 1, 1);
+            break;
         default:
             return 0;
     }
@@ -0,0 +1,133 @@
+/*******************************************************************************/
+/*  © Université Lille 1, The Pip Development Team (2015-2017)                 */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/**
+ * \file pipstat.c
+ * \brief Per-core pipcall counters and latency histograms
+ */
+
+#include <stdint.h>
+#include "pipstat.h"
+#include "gdt.h"
+#include "mal.h"
+
+/**
+ * \struct pipcall_stat
+ * \brief Counters of one pipcall on one core
+ */
+struct pipcall_stat {
+	uint32_t count; //!< Calls entered
+	uint32_t hist[PIPSTAT_BUCKETS]; //!< Calls per log2 of their duration in cycles
+};
+
+/**
+ * \struct pipcall_core_stat
+ * \brief Counters of one core, only written by that core
+ */
+struct pipcall_core_stat {
+	uint32_t open; //!< Call being timed + 1, 0 if none
+	uint32_t start; //!< TSC low word when it was entered
+	struct pipcall_stat calls[PIPCALL_COUNT];
+} __attribute__((aligned(64)));
+
+static struct pipcall_core_stat pipcallStats[PIPSTAT_CORES];
+
+static inline uint32_t rdtscLow(void)
+{
+	uint32_t low, high;
+	asm volatile("rdtsc": "=a"(low), "=d"(high));
+	return low;
+}
+
+/**
+ * \fn void pipcallStatEnter(uint32_t call)
+ * \brief Counts a pipcall and starts timing it
+ * \param call The PIPCALL_* number
+ */
+void pipcallStatEnter(uint32_t call)
+{
+	uint32_t core = tssCoreId();
+
+	if(core >= PIPSTAT_CORES || call >= PIPCALL_COUNT)
+		return;
+
+	pipcallStats[core].calls[call].count++;
+	pipcallStats[core].open = call + 1;
+	pipcallStats[core].start = rdtscLow();
+}
+
+/**
+ * \fn void pipcallStatLeave(void)
+ * \brief Files the duration of the pipcall being timed into its histogram
+ * \note Called on the way back to userland, and before dispatch or resume
+ *       switch to another partition. Does nothing when no call is timed,
+ *       e.g. when dispatching a hardware interrupt.
+ */
+void pipcallStatLeave(void)
+{
+	uint32_t core = tssCoreId();
+	uint32_t cycles, bucket;
+
+	if(core >= PIPSTAT_CORES || !pipcallStats[core].open)
+		return;
+
+	cycles = rdtscLow() - pipcallStats[core].start;
+	bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+	pipcallStats[core].calls[pipcallStats[core].open - 1].hist[bucket]++;
+	pipcallStats[core].open = 0;
+}
+
+/**
+ * \fn uint32_t pipcallStatQuery(uint32_t query)
+ * \brief Reads one counter, for the root partition only
+ * \param query A PIPSTAT_QUERY(core, call, bucket) value, bucket being
+ *        PIPSTAT_COUNT for the call count
+ * \return The counter, 0 for an invalid query or another caller
+ */
+uint32_t pipcallStatQuery(uint32_t query)
+{
+	uint32_t core = query >> 16;
+	uint32_t call = (query >> 8) & 0xFF;
+	uint32_t bucket = query & 0xFF;
+
+	if(getCurPartition() != getRootPartition())
+		return 0;
+	if(core >= PIPSTAT_CORES || call >= PIPCALL_COUNT)
+		return 0;
+
+	if(bucket == PIPSTAT_COUNT)
+		return pipcallStats[core].calls[call].count;
+	if(bucket >= PIPSTAT_BUCKETS)
+		return 0;
+	return pipcallStats[core].calls[call].hist[bucket];
+}
@@ -42,6 +42,10 @@
 #include "x86int.h"
 #include "debug.h"
 #include "pic8259.h"
+#include "maldefines.h"
+#include "gdt.h"
+#include "libc.h"
+#include "lock.h"
 
 /* Get hardware index from IO-to-Hardware table */
 //extern uint16_t io_to_hardware[X86_MAX_IO];
@@ -69,6 +73,218 @@ ioAccessValid(uint16_t port)
 	else return 1; // For now, allow any IO. TODO : fix this according to new IAL
 }
 
+/* IO port grants. A parent hands port ranges down to a child with
+ * ioGrantGlue; the ranges of the active partition are cleared in the TSS IO
+ * bitmap of the core, so that it runs in/out natively on them. Other ports
+ * still go through the IO callgates. Grants only change the bitmaps on the
+ * next partition switch of each core. */
+#define IOGRANT_MAX		32 /* ioGrantsBelow returns a mask of slots */
+#define IOGRANT_CORES	16
+#define IOGRANT_DEPTH	64 /* Bounds the ancestor walk of ioGrantsBelow */
+
+struct iogrant {
+	uint32_t partition;	/* Grantee descriptor paddr, 0 if the slot is free */
+	uint32_t first;		/* First port of the range */
+	uint32_t last;		/* Last port of the range */
+};
+
+static struct iogrant ioGrants[IOGRANT_MAX];
+static spinlock_t ioGrantLock; /* Serializes grant updates, readers don't take it */
+static volatile uint32_t ioGrantGeneration = 1;
+static uint32_t ioLoaded[IOGRANT_CORES]; /* Partition whose ranges are open in the core's bitmap */
+static uint32_t ioLoadedGeneration[IOGRANT_CORES];
+
+extern int checkChild(const uintptr_t partition, const uint32_t l1, const uintptr_t va);
+extern uint32_t readPaddr(uint32_t partition, uint32_t vaddr);
+
+/**
+ * \fn static void ioMapSet(uint8_t *map, uint32_t first, uint32_t last, uint32_t deny)
+ * \brief Sets or clears the bitmap bits of a port range
+ */
+static void ioMapSet(uint8_t *map, uint32_t first, uint32_t last, uint32_t deny)
+{
+	uint32_t port;
+	for(port = first; port <= last; port++)
+	{
+		if(deny)
+			map[port >> 3] |= 1 << (port & 7);
+		else
+			map[port >> 3] &= ~(1 << (port & 7));
+	}
+}
+
+/**
+ * \fn void ioBitmapSwitch(uint32_t partition)
+ * \brief Opens the ports granted to a partition in the running core's TSS
+ * \param partition The partition being activated
+ */
+void ioBitmapSwitch(uint32_t partition)
+{
+	uint32_t core = tssCoreId();
+	uint32_t generation = ioGrantGeneration;
+	uint8_t *map;
+	uint32_t i;
+
+	if(core >= IOGRANT_CORES)
+		return;
+	if(ioLoaded[core] == partition && ioLoadedGeneration[core] == generation)
+		return;
+
+	map = tssEntry[core].iomap;
+	if(ioLoadedGeneration[core] != generation)
+	{
+		/* The grants changed : the previous ranges are unknown */
+		memset(map, 0xFF, IOMAP_BYTES);
+	}
+	else
+	{
+		for(i = 0; i < IOGRANT_MAX; i++)
+			if(ioGrants[i].partition && ioGrants[i].partition == ioLoaded[core])
+				ioMapSet(map, ioGrants[i].first, ioGrants[i].last, 1);
+	}
+
+	for(i = 0; i < IOGRANT_MAX; i++)
+		if(ioGrants[i].partition == partition)
+			ioMapSet(map, ioGrants[i].first, ioGrants[i].last, 0);
+
+	ioLoaded[core] = partition;
+	ioLoadedGeneration[core] = generation;
+}
+
+/**
+ * \fn static uint32_t ioGranted(uint32_t partition, uint32_t first, uint32_t last)
+ * \brief Checks a partition may hand a port range down
+ * \return 1 if the root partition or if the whole range was granted to it
+ */
+static uint32_t ioGranted(uint32_t partition, uint32_t first, uint32_t last)
+{
+	uint32_t port = first, i, progress = 1;
+
+	if(partition == getRootPartition())
+		return 1;
+
+	/* Granted ranges may be split, walk the range until no grant extends it */
+	while(progress)
+	{
+		progress = 0;
+		for(i = 0; i < IOGRANT_MAX; i++)
+		{
+			if(ioGrants[i].partition == partition
+			   && ioGrants[i].first <= port && port <= ioGrants[i].last)
+			{
+				if(ioGrants[i].last >= last)
+					return 1;
+				port = ioGrants[i].last + 1;
+				progress = 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/**
+ * \fn uint32_t ioGrantsBelow(uint32_t partition)
+ * \brief Lists the grants of a partition and of its descendants
+ * \param partition The partition descriptor, as a physical address
+ * \return A mask of grant slots, for ioGrantDrop
+ * \note The descriptors are walked, so this has to run before they go away.
+ */
+uint32_t ioGrantsBelow(uint32_t partition)
+{
+	uint32_t root = getRootPartition();
+	uint32_t i, depth, t, slots = 0;
+
+	MP_LOCK(ioGrantLock);
+	for(i = 0; i < IOGRANT_MAX; i++)
+	{
+		for(t = ioGrants[i].partition, depth = 0; t && t != root && depth < IOGRANT_DEPTH; depth++)
+		{
+			if(t == partition)
+			{
+				slots |= 1 << i;
+				break;
+			}
+			t = readPhysicalNoFlags(t, PPRidx() + 1);
+		}
+	}
+	MP_UNLOCK(ioGrantLock);
+	return slots;
+}
+
+/**
+ * \fn void ioGrantDrop(uint32_t slots)
+ * \brief Frees the grant slots listed by ioGrantsBelow
+ */
+void ioGrantDrop(uint32_t slots)
+{
+	uint32_t i;
+
+	if(!slots)
+		return;
+	MP_LOCK(ioGrantLock);
+	for(i = 0; i < IOGRANT_MAX; i++)
+		if(slots & (1 << i))
+			ioGrants[i].partition = 0;
+	__sync_fetch_and_add(&ioGrantGeneration, 1);
+	MP_UNLOCK(ioGrantLock);
+}
+
+/**
+ * \fn uint32_t ioGrantGlue(uint32_t child, uint32_t port, uint32_t count)
+ * \brief Glue function for ioGrant callgate : lets a child use IO ports natively
+ * \param child The child descriptor, as a virtual address of the caller
+ * \param port First port of the range
+ * \param count Number of ports, 0 to revoke every port of the child and its descendants
+ * \return 1 on success, 0 otherwise
+ * \note The caller has to hold the range itself, and the PIC ports are never granted.
+ */
+uint32_t ioGrantGlue(uint32_t child, uint32_t port, uint32_t count)
+{
+	uint32_t caller = getCurPartition();
+	uint32_t to, last, i;
+
+	if(!checkChild(caller, getNbLevel(), child))
+		return 0;
+	if((to = readPaddr(caller, child)) == (uint32_t)-1)
+		return 0;
+
+	if(!count)
+	{
+		ioGrantDrop(ioGrantsBelow(to));
+		return 1;
+	}
+
+	last = port + count - 1;
+	if(port > 0xFFFF || count > 0x10000 || last > 0xFFFF)
+		return 0;
+	for(i = port; i <= last; i++)
+		if(!ioAccessValid((uint16_t)i))
+			return 0;
+	if(!ioGranted(caller, port, last))
+	{
+		DEBUG(WARNING, "Partition %x tried to grant ports %x-%x it does not hold\n", caller, port, last);
+		return 0;
+	}
+
+	MP_LOCK(ioGrantLock);
+	for(i = 0; i < IOGRANT_MAX; i++)
+	{
+		if(!ioGrants[i].partition)
+		{
+			ioGrants[i].first = port;
+			ioGrants[i].last = last;
+			ioGrants[i].partition = to;
+			__sync_fetch_and_add(&ioGrantGeneration, 1);
+			MP_UNLOCK(ioGrantLock);
+			return 1;
+		}
+	}
+	MP_UNLOCK(ioGrantLock);
+
+	DEBUG(WARNING, "No IO grant slot left\n");
+	return 0;
+}
+
 /**
  * \fn void outb(uint16_t port, uint8_t value)
  * \brief Out operation on 1-byte value
@@ -328,6 +544,143 @@ uint32_t inlGlue(uint32_t port, gate_ctx_t *ctx)
 	return ret;
 }
 
+/**
+ * \fn uint32_t userBufferMapped(uint32_t buffer, uint32_t size, uint32_t writable)
+ * \brief Checks the current partition may access the whole buffer
+ * \param buffer Virtual address of the buffer
+ * \param size Size of the buffer in bytes
+ * \param writable Whether the buffer has to be writable as well
+ * \return 1 if every page is present and user accessible, 0 otherwise
+ */
+uint32_t userBufferMapped(uint32_t buffer, uint32_t size, uint32_t writable)
+{
+	uint32_t pd = readPhysicalNoFlags(getCurPartition(), indexPD() + 1);
+	uint32_t flags = writable ? 0x7 : 0x5;
+	uint32_t va, pde, pte;
+
+	if(!size || buffer + size < buffer)
+		return 0;
+
+	for(va = buffer & ~0xFFF; va < buffer + size && va >= (buffer & ~0xFFF); va += 0x1000)
+	{
+		pde = readPhysical(pd, getIndexOfAddr(va, 1));
+		if((pde & 0x5) != 0x5)
+			return 0;
+		pte = readPhysical(pde & ~0xFFF, getIndexOfAddr(va, 0));
+		if((pte & flags) != flags)
+			return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * \fn static uint32_t ioString(const struct io_op *o)
+ * \brief Runs a rep ins/outs descriptor
+ * \param o Kernel copy of the descriptor
+ * \return 1 if done, 0 if the buffer is not accessible
+ */
+static uint32_t ioString(const struct io_op *o)
+{
+	uint32_t in = o->op >= IO_OP_INSB;
+	uint32_t width = 1 << ((o->op - IO_OP_OUTSB) % 3);
+	uint32_t buffer = o->value, count = o->count;
+
+	if(count > 0xFFFFFFFF / width || !userBufferMapped(buffer, count * width, in))
+		return 0;
+
+	switch(o->op)
+	{
+		case IO_OP_OUTSB:
+			asm volatile("cld; rep outsb" : "+S"(buffer), "+c"(count) : "d"(o->port) : "memory");
+			break;
+		case IO_OP_OUTSW:
+			asm volatile("cld; rep outsw" : "+S"(buffer), "+c"(count) : "d"(o->port) : "memory");
+			break;
+		case IO_OP_OUTSL:
+			asm volatile("cld; rep outsl" : "+S"(buffer), "+c"(count) : "d"(o->port) : "memory");
+			break;
+		case IO_OP_INSB:
+			asm volatile("cld; rep insb" : "+D"(buffer), "+c"(count) : "d"(o->port) : "memory");
+			break;
+		case IO_OP_INSW:
+			asm volatile("cld; rep insw" : "+D"(buffer), "+c"(count) : "d"(o->port) : "memory");
+			break;
+		case IO_OP_INSL:
+			asm volatile("cld; rep insl" : "+D"(buffer), "+c"(count) : "d"(o->port) : "memory");
+			break;
+	}
+	return 1;
+}
+
+/**
+ * \fn uint32_t ioBatchGlue(uint32_t ops, uint32_t count)
+ * \brief Glue function for ioBatch callgate : runs an array of IO accesses
+ * \param ops Virtual address of an array of count io_op descriptors
+ * \param count Number of descriptors, at most IO_BATCH_MAX
+ * \return The number of descriptors run
+ * \note Reads are returned in place, in the value field. The batch stops at
+ *       the first forbidden port, unknown operation or inaccessible buffer.
+ *       The call runs under the pipcall lock, so the pages checked stay
+ *       mapped until the results are written back. The array stays writable
+ *       by the partition on other cores though, so each descriptor is copied
+ *       once and only the copy is checked and run.
+ */
+uint32_t ioBatchGlue(uint32_t ops, uint32_t count)
+{
+	struct io_op *user = (struct io_op*)ops;
+	struct io_op o;
+	uint32_t i;
+
+	if(count > IO_BATCH_MAX
+	   || !userBufferMapped(ops, count * sizeof(struct io_op), 1))
+		return 0;
+
+	for(i = 0; i < count; i++)
+	{
+		o = user[i];
+		/* Keep the compiler from reading the descriptor from user memory again */
+		asm volatile("" ::: "memory");
+
+		if(o.port > 0xFFFF || !ioAccessValid((uint16_t)o.port))
+		{
+			DEBUG(WARNING, "ioBatch: forbidden IO access on port %x\n", o.port);
+			break;
+		}
+
+		switch(o.op)
+		{
+			case IO_OP_OUTB:
+				outb((uint16_t)o.port, (uint8_t)(o.value & 0xff));
+				break;
+			case IO_OP_OUTW:
+				outw((uint16_t)o.port, (uint16_t)(o.value & 0xffff));
+				break;
+			case IO_OP_OUTL:
+				outl((uint16_t)o.port, o.value);
+				break;
+			case IO_OP_INB:
+				user[i].value = inb((uint16_t)o.port);
+				break;
+			case IO_OP_INW:
+				user[i].value = inw((uint16_t)o.port);
+				break;
+			case IO_OP_INL:
+				user[i].value = inl((uint16_t)o.port);
+				break;
+			case IO_OP_OUTSB: case IO_OP_OUTSW: case IO_OP_OUTSL:
+			case IO_OP_INSB: case IO_OP_INSW: case IO_OP_INSL:
+				if(!ioString(&o))
+					return i;
+				break;
+			default:
+				return i;
+		}
+	}
+
+	return i;
+}
+
 /**
  * \fn uint32_t timerGlue(void)
  * \brief Glue function for timer callgate
@@ -0,0 +1,97 @@
+/*******************************************************************************/
+/*  © Université Lille 1, The Pip Development Team (2015-2017)                 */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/**
+ * \file range.c
+ * \brief Range mapping callgates, one kernel entry for many pages
+ */
+
+#include <stdint.h>
+#include "mmu.h"
+
+/* Rights bits of the rights argument, as in libpip */
+#define RANGE_READ	0x1
+#define RANGE_WRITE	0x2
+#define RANGE_EXEC	0x4
+
+extern uint32_t addVAddr(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+extern uint32_t removeVAddr(uint32_t, uint32_t);
+extern void pdcacheInvalidate(void);
+
+/**
+ * \fn uint32_t mapRangeGlue(uint32_t source, uint32_t child, uint32_t destination, uint32_t count, uint32_t rights)
+ * \brief Maps count pages from consecutive source addresses to consecutive destination addresses in a child
+ * \param source The first virtual address in the current partition
+ * \param child The partition descriptor of the child
+ * \param destination The first virtual address in the child
+ * \param count The number of pages to map
+ * \param rights The RANGE_READ/RANGE_WRITE/RANGE_EXEC rights for every page
+ * \return The number of pages mapped, the range stops at the first failure
+ * \note The child indirection tables must have been prepared for the whole range beforehand
+ */
+uint32_t mapRangeGlue(uint32_t source, uint32_t child, uint32_t destination, uint32_t count, uint32_t rights)
+{
+	uint32_t r = (rights & RANGE_READ) ? 1 : 0;
+	uint32_t w = (rights & RANGE_WRITE) ? 1 : 0;
+	uint32_t e = (rights & RANGE_EXEC) ? 1 : 0;
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		if (!addVAddr(source + i * PAGE_SIZE, child, destination + i * PAGE_SIZE, r, w, e))
+			break;
+	}
+
+	return i;
+}
+
+/**
+ * \fn uint32_t unmapRangeGlue(uint32_t child, uint32_t destination, uint32_t count)
+ * \brief Removes count pages at consecutive addresses from a child
+ * \param child The partition descriptor of the child
+ * \param destination The first virtual address in the child
+ * \param count The number of pages to remove
+ * \return The number of pages removed, the range stops at the first failure
+ */
+uint32_t unmapRangeGlue(uint32_t child, uint32_t destination, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		if (!removeVAddr(child, destination + i * PAGE_SIZE))
+			break;
+	}
+
+	/* The range may have held a VIDT cached by dispatch */
+	pdcacheInvalidate();
+	return i;
+}
@@ -7,19 +7,24 @@
 extern void init_msr(uint32_t st);
 extern uint32_t *_sysenter_stacks;
 
-#define PIPCALL_COUNT   20
 /* System calls */
 extern uint32_t createPartition(uint32_t,uint32_t,uint32_t,uint32_t,uint32_t);
 extern uint32_t countToMap(uint32_t,uint32_t);
 extern uint32_t prepare(uint32_t, uint32_t, uint32_t, uint32_t);
 extern uint32_t addVAddr(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
 extern uint32_t resume(uint32_t, uint32_t);
-extern uint32_t removeVAddr(uint32_t, uint32_t);
+extern uint32_t removeVAddrGlue(uint32_t, uint32_t);
 extern uint32_t mappedInChild(uint32_t);
-extern uint32_t deletePartition(uint32_t);
-extern uint32_t collect(uint32_t,uint32_t);
+extern uint32_t deletePartitionGlue(uint32_t);
+extern uint32_t collectGlue(uint32_t,uint32_t);
 extern uint32_t smpRequest(uint32_t, uint32_t);
 extern uint32_t dispatchGlue(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+extern uint32_t mapRangeGlue(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+extern uint32_t unmapRangeGlue(uint32_t, uint32_t, uint32_t);
+extern uint32_t traceDrainGlue(uint32_t, uint32_t, uint32_t);
+extern uint32_t irqRouteGlue(uint32_t, uint32_t);
+extern uint32_t ioBatchGlue(uint32_t, uint32_t);
+extern uint32_t ioGrantGlue(uint32_t, uint32_t, uint32_t);
 
 extern uint32_t outbGlue(uint32_t, uint32_t);
 extern uint32_t outwGlue(uint32_t, uint32_t);
@@ -42,10 +47,10 @@ void *syscall_table[PIPCALL_COUNT] =
     &dispatchGlue,
     &timerGlue,
     &resume,
-    &removeVAddr,
+    &removeVAddrGlue,
     &mappedInChild,
-    &deletePartition,
-    &collect,
+    &deletePartitionGlue,
+    &collectGlue,
     &smpRequest,
     &outbGlue,
     &inbGlue,
@@ -55,6 +60,21 @@ void *syscall_table[PIPCALL_COUNT] =
     &inlGlue,
     &outaddrlGlue,
     &slputs_sync,
+    &mapRangeGlue,
+    &unmapRangeGlue,
+    &traceDrainGlue,
+    &irqRouteGlue,
+    &ioBatchGlue,
+    &ioGrantGlue,
+};
+
+/* Calls that only read state run without the pipcall lock, as their
+ * CG_GLUE_NOLOCK callgates do */
+uint8_t syscall_nolock[PIPCALL_COUNT] =
+{
+    [PIPCALL_COUNTTOMAP] = 1,
+    [PIPCALL_MAPPEDINCHILD] = 1,
+    [PIPCALL_SMPREQUEST] = 1,
 };
 
 void sysenter_c_ep(uint32_t syscall_id, uint32_t esp, uint32_t eip)
@@ -0,0 +1,121 @@
+/*******************************************************************************/
+/*  © Université Lille 1, The Pip Development Team (2015-2017)                 */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/**
+ * \file timepage.c
+ * \brief Read-only time page shared with every partition
+ */
+
+#include <stdint.h>
+#include "timepage.h"
+#include "port.h"
+#include "mal.h"
+#include "structures.h"
+#include "debug.h"
+#include "mp.h"
+
+/* Padded to a whole page : nothing else may become user-readable with it */
+static union {
+	struct timepage page;
+	uint8_t raw[PAGE_SIZE];
+} timePageFrame __attribute__((aligned(PAGE_SIZE)));
+#define timePage timePageFrame.page
+
+#define PIT_HZ			1193182
+#define CALIBRATE_MS	10
+
+static inline uint64_t rdtsc64(void)
+{
+	uint32_t low, high;
+	asm volatile("rdtsc": "=a"(low), "=d"(high));
+	return ((uint64_t)high << 32) | low;
+}
+
+/**
+ * \fn void timepageInit(void)
+ * \brief Measures the TSC against PIT channel 2 and publishes the page
+ * \note Runs on the BSP with interrupts off, before any partition exists :
+ *       the page never changes afterwards, readers need no sequence counter.
+ *       APs are assumed to share the BSP's TSC.
+ */
+void timepageInit(void)
+{
+	uint32_t count = PIT_HZ / (1000 / CALIBRATE_MS);
+	uint64_t start, stop;
+
+	/* Channel 2 gate on, speaker off, one-shot countdown */
+	outb(0x61, (inb(0x61) & ~0x02) | 0x01);
+	outb(0x43, 0xB0);
+	outb(0x42, count & 0xFF);
+	outb(0x42, count >> 8);
+
+	start = rdtsc64();
+	while(!(inb(0x61) & 0x20));
+	stop = rdtsc64();
+
+	timePage.tscBase = start;
+	timePage.tscKhz = (uint32_t)((stop - start) / CALIBRATE_MS);
+	timePage.magic = TIMEPAGE_MAGIC;
+	DEBUG(CRITICAL, "TSC runs at %d kHz\n", timePage.tscKhz);
+}
+
+/**
+ * \fn void timepageMap(uint32_t dir)
+ * \brief Makes the time page user-readable and read-only in a kernel page directory
+ * \param dir The kernel page directory, paging being still disabled
+ * \note The kernel page table is shared by every partition : so is the page.
+ *       CR0.WP is clear, the kernel still writes it through the same mapping.
+ */
+void timepageMap(uint32_t dir)
+{
+	uint32_t kpt = readTableVirtual(dir, kernelIndex());
+	page_table_entry_t* entry = (page_table_entry_t*)kpt + getIndexOfAddr((uint32_t)&timePageFrame, 0);
+
+	if(getIndexOfAddr((uint32_t)&timePageFrame, 1) != kernelIndex())
+	{
+		DEBUG(CRITICAL, "Time page is out of the kernel page table, not sharing it.\n");
+		return;
+	}
+
+	entry->rw = 0;
+	entry->user = 1;
+}
+
+/**
+ * \fn uint32_t timepageAddr(void)
+ * \brief Gets the address of the time page
+ */
+uint32_t timepageAddr(void)
+{
+	return (uint32_t)&timePage;
+}
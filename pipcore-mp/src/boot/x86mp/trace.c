@@ -0,0 +1,210 @@
+/*******************************************************************************/
+/*  © Université Lille 1, The Pip Development Team (2015-2017)                 */
+/*                                                                             */
+/*  This software is a computer program whose purpose is to run a minimal,     */
+/*  hypervisor relying on proven properties such as memory isolation.          */
+/*                                                                             */
+/*  This software is governed by the CeCILL license under French law and       */
+/*  abiding by the rules of distribution of free software.  You can  use,      */
+/*  modify and/ or redistribute the software under the terms of the CeCILL     */
+/*  license as circulated by CEA, CNRS and INRIA at the following URL          */
+/*  "http://www.cecill.info".                                                  */
+/*                                                                             */
+/*  As a counterpart to the access to the source code and  rights to copy,     */
+/*  modify and redistribute granted by the license, users are provided only    */
+/*  with a limited warranty  and the software's author,  the holder of the     */
+/*  economic rights,  and the successive licensors  have only  limited         */
+/*  liability.                                                                 */
+/*                                                                             */
+/*  In this respect, the user's attention is drawn to the risks associated     */
+/*  with loading,  using,  modifying and/or developing or reproducing the      */
+/*  software by the user in light of its specific status of free software,     */
+/*  that may mean  that it is complicated to manipulate,  and  that  also      */
+/*  therefore means  that it is reserved for developers  and  experienced      */
+/*  professionals having in-depth computer knowledge. Users are therefore      */
+/*  encouraged to load and test the software's suitability as regards their    */
+/*  requirements in conditions enabling the security of their systems and/or   */
+/*  data to be ensured and,  more generally, to use and operate it in the      */
+/*  same conditions as regards security.                                       */
+/*                                                                             */
+/*  The fact that you are presently reading this means that you have had       */
+/*  knowledge of the CeCILL license and that you accept its terms.             */
+/*******************************************************************************/
+
+/**
+ * \file trace.c
+ * \brief Per-core binary trace rings
+ */
+
+#include <stdint.h>
+#include "trace.h"
+#include "mal.h"
+#include "lock.h"
+#include "gdt.h"
+
+/**
+ * \struct trace_ring
+ * \brief Records of one core. Only that core writes records, any core drains.
+ */
+struct trace_ring {
+	volatile uint32_t head; //!< Records reserved so far, free running
+	uint32_t tail; //!< Next record to drain
+	uint32_t lost; //!< Lost records not reported yet
+	spinlock_t drain; //!< Serializes drains of this ring
+	struct trace_record records[TRACE_RING_SIZE];
+} __attribute__((aligned(64)));
+
+static struct trace_ring traceRings[TRACE_CORES];
+
+/**
+ * \fn void traceEvent(uint32_t event, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+ * \brief Records an event into the running core's ring
+ * \param event TRACE_EV_* identifier
+ * \param a First event argument
+ * \param b Second event argument
+ * \param c Third event argument
+ * \param d Fourth event argument
+ * \note The oldest record is overwritten when the ring is full
+ */
+void traceEvent(uint32_t event, uint32_t a, uint32_t b, uint32_t c, uint32_t d)
+{
+	uint32_t core = tssCoreId(), index = 1;
+	uint32_t low, high;
+
+	if(core >= TRACE_CORES)
+		return;
+
+	/* A single xadd cannot be split by an interrupt on this core */
+	struct trace_ring *ring = &traceRings[core];
+	asm volatile("xaddl %0, %1": "+r"(index), "+m"(ring->head):: "memory");
+	struct trace_record *rec = &ring->records[index & (TRACE_RING_SIZE - 1)];
+
+	rec->seq = 0;
+	asm volatile("": : : "memory");
+	asm volatile("rdtsc": "=a"(low), "=d"(high));
+	rec->event = event;
+	rec->core = core;
+	rec->tsc = ((uint64_t)high << 32) | low;
+	rec->args[0] = a;
+	rec->args[1] = b;
+	rec->args[2] = c;
+	rec->args[3] = d;
+	asm volatile("": : : "memory");
+	rec->seq = index + 1;
+}
+
+/**
+ * \fn static uint32_t traceUserWritable(uint32_t buffer, uint32_t size)
+ * \brief Checks the current partition may write the whole buffer
+ * \param buffer Virtual address of the buffer
+ * \param size Size of the buffer in bytes
+ * \return 1 if every page is present, writable and user accessible, 0 otherwise
+ */
+static uint32_t traceUserWritable(uint32_t buffer, uint32_t size)
+{
+	uint32_t pd = readPhysicalNoFlags(getCurPartition(), indexPD() + 1);
+	uint32_t va, pde, pte;
+
+	if(!size || buffer + size < buffer)
+		return 0;
+
+	for(va = buffer & ~0xFFF; va < buffer + size && va >= (buffer & ~0xFFF); va += 0x1000)
+	{
+		pde = readPhysical(pd, getIndexOfAddr(va, 1));
+		if((pde & 0x7) != 0x7)
+			return 0;
+		pte = readPhysical(pde & ~0xFFF, getIndexOfAddr(va, 0));
+		if((pte & 0x7) != 0x7)
+			return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * \fn static void traceLost(struct trace_record *out, uint32_t core, uint32_t lost)
+ * \brief Builds the record telling lost records apart from a quiet core
+ */
+static void traceLost(struct trace_record *out, uint32_t core, uint32_t lost)
+{
+	out->seq = 0;
+	out->event = TRACE_EV_LOST;
+	out->core = core;
+	out->tsc = 0;
+	out->args[0] = lost;
+	out->args[1] = out->args[2] = out->args[3] = 0;
+}
+
+/**
+ * \fn uint32_t traceDrainGlue(uint32_t core, uint32_t buffer, uint32_t count)
+ * \brief Copies the oldest records of a core's ring into the caller's buffer
+ * \param core The core whose ring is drained
+ * \param buffer Virtual address of an array of count trace records
+ * \param count Size of the buffer, in records
+ * \return The number of records copied, 0 when the caller is not the root partition
+ * \note Overwritten records are reported by a TRACE_EV_LOST record. The call
+ *       runs under the pipcall lock : the buffer checked stays mapped while
+ *       the records are copied out.
+ */
+uint32_t traceDrainGlue(uint32_t core, uint32_t buffer, uint32_t count)
+{
+	struct trace_record *out = (struct trace_record*)buffer;
+	struct trace_ring *ring;
+	struct trace_record rec;
+	uint32_t head, n = 0;
+
+	if(getCurPartition() != getRootPartition() || core >= TRACE_CORES)
+		return 0;
+	if(count > 0xFFFFFFFF / sizeof(struct trace_record)
+	   || !traceUserWritable(buffer, count * sizeof(struct trace_record)))
+		return 0;
+
+	ring = &traceRings[core];
+	MP_LOCK(ring->drain);
+
+	head = ring->head;
+	if(head - ring->tail > TRACE_RING_SIZE)
+	{
+		ring->lost += head - ring->tail - TRACE_RING_SIZE;
+		ring->tail = head - TRACE_RING_SIZE;
+	}
+
+	while(n < count && ring->tail != head)
+	{
+		struct trace_record *src = &ring->records[ring->tail & (TRACE_RING_SIZE - 1)];
+		uint32_t seq = src->seq;
+
+		/* Not complete yet : either being written or about to be reused */
+		if((int32_t)(seq - (ring->tail + 1)) < 0)
+			break;
+
+		rec = *src;
+		asm volatile("": : : "memory");
+		if(seq != ring->tail + 1 || src->seq != seq)
+		{
+			/* Overwritten by the writer, before or while we copied it */
+			ring->lost++;
+			ring->tail++;
+			continue;
+		}
+
+		if(ring->lost)
+		{
+			if(n + 1 >= count)
+				break;
+			traceLost(&out[n++], core, ring->lost);
+			ring->lost = 0;
+		}
+		out[n++] = rec;
+		ring->tail++;
+	}
+
+	if(ring->lost && n < count)
+	{
+		traceLost(&out[n++], core, ring->lost);
+		ring->lost = 0;
+	}
+
+	MP_UNLOCK(ring->drain);
+	return n;
+}
@@ -39,8 +39,10 @@
 #include "libc.h"
 #include "debug.h"
 #include "lock.h"
+#include "mal.h"
 
 tss_entry_t tssEntry[16]; //!< Generic TSS entry for userland-to-kernel switch
+uint32_t tssBase;
 extern void tssFlush(); //!< ASM method to flush the TSS entry
 
 extern void *cg_outbGlue;
@@ -62,6 +64,9 @@ extern void *cg_mappedInChild;
 extern void *cg_deletePartition;
 extern void *cg_collect;
 extern void *cg_smpRequest;
+extern void *cg_mapRangeGlue;
+extern void *cg_unmapRangeGlue;
+extern void *cg_traceDrainGlue;
 
 /**
  * \struct gdt_entry_s
@@ -96,6 +101,9 @@ struct gdt_entry_s gdtEntries[] = {
 	{&cg_deletePartition,1,0x3, 0x08}, /* 0xB0 */
 	{&cg_collect,		1, 0x3, 0x08}, /* 0xB8 */
     {&cg_smpRequest,    2, 0x3, 0x08}, /* 0xC0 */
+	{&cg_mapRangeGlue,	5, 0x3, 0x08}, /* 0xC8 */
+	{&cg_unmapRangeGlue,	3, 0x3, 0x08}, /* 0xD0 */
+	{&cg_traceDrainGlue,	3, 0x3, 0x08}, /* 0xD8 */
 };
 
 #define CG_COUNT (sizeof(gdtEntries)/sizeof(struct gdt_entry_s))
@@ -233,11 +241,12 @@ void gdtInstall(void)
 	}
 
     /* SMP TSS entries at the end of callgate entries */
-    writeTss(6+CG_COUNT, 0x10, 0x0, 0x0); /* 0xC8 */
-    writeTss(7+CG_COUNT, 0x10, 0x0, 0x1); /* 0xD0 */
-    writeTss(8+CG_COUNT, 0x10, 0x0, 0x2); /* 0xD8 */
-    writeTss(9+CG_COUNT, 0x10, 0x0, 0x3); /* 0xE0 */
+    writeTss(6+CG_COUNT, 0x10, 0x0, 0x0); /* 0xE0 */
+    writeTss(7+CG_COUNT, 0x10, 0x0, 0x1); /* 0xE8 */
+    writeTss(8+CG_COUNT, 0x10, 0x0, 0x2); /* 0xF0 */
+    writeTss(9+CG_COUNT, 0x10, 0x0, 0x3); /* 0xF8 */
 	
+	tssBase = 6 + CG_COUNT;
 	DEBUG(INFO, "Callgate set-up\r\n");
     DEBUG(CRITICAL, "BSP GDTPtr at %x.\r\n", &gp);
 	gdtFlush();
@@ -254,16 +263,64 @@ void dumpStuff()
     return;
 }
 
-static spinlock_t api_spinlock = 0;
+/* Pipcalls only walk the partition tree of the caller, up to its root
+ * partition, so cores running separate root partitions never share state.
+ * Each tree gets its own lock; in the multi-thread model every core runs
+ * the same root and they all serialize on a single lock, as before. */
+#define API_LOCK_COUNT  16
+
+static spinlock_t api_spinlocks[API_LOCK_COUNT];
+uint32_t api_lock_acquired[API_LOCK_COUNT]; //!< Pipcalls that took each lock
+uint32_t api_lock_contended[API_LOCK_COUNT]; //!< Pipcalls that had to spin on it
+
+/* Lock taken by each core, plus one, or 0. dispatchAsm and resumeAsm release
+ * on every path, also when an interrupt and not a pipcall led there: only the
+ * lock the core took, if any, is released */
+#define API_LOCK_CORES  16
+static uint32_t api_lock_held[API_LOCK_CORES];
+
+static inline uint32_t api_lock_index(void)
+{
+    return (getRootPartition() >> 12) % API_LOCK_COUNT;
+}
 
 void api_lock()
 {
-    MP_LOCK(api_spinlock);
+    uint32_t idx = api_lock_index();
+    uint32_t core = tssCoreId();
+
+    if(__sync_lock_test_and_set(&api_spinlocks[idx], 1))
+    {
+        __sync_fetch_and_add(&api_lock_contended[idx], 1);
+        MP_LOCK(api_spinlocks[idx]);
+    }
+    api_lock_acquired[idx]++;
+    if(core < API_LOCK_CORES)
+        api_lock_held[core] = idx + 1;
     return;
 }
 
 void api_unlock()
 {
-    MP_UNLOCK(api_spinlock);
+    uint32_t core = tssCoreId();
+    uint32_t held;
+
+    if(core >= API_LOCK_CORES || !api_lock_held[core])
+        return;
+    held = api_lock_held[core] - 1;
+    api_lock_held[core] = 0;
+    MP_UNLOCK(api_spinlocks[held]);
     return;
 }
+
+/**
+ * \fn uint32_t api_lock_stat(uint32_t contended)
+ * \brief Reads the counters of the lock guarding the caller's partition tree
+ * \param contended 1 for the contended count, 0 for the acquired count
+ * \return The counter value
+ */
+uint32_t api_lock_stat(uint32_t contended)
+{
+    uint32_t idx = api_lock_index();
+    return contended ? api_lock_contended[idx] : api_lock_acquired[idx];
+}
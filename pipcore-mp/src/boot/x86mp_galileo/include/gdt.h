@@ -128,6 +128,25 @@ extern void tssFlush();
 
 void setKernelStack(uint32_t stack);
 
+extern uint32_t tssBase; //!< GDT index of core 0's TSS, the other cores follow
+
+/**
+ * \fn static inline uint32_t tssCoreId(void)
+ * \brief Gets the running core from its TSS selector, much cheaper than the CPUID behind coreId()
+ * \return The core index, out of range before the core loaded its TSS
+ */
+static inline uint32_t tssCoreId(void)
+{
+	uint32_t tr;
+	asm volatile("str %0": "=r"(tr));
+	return (tr >> 3) - tssBase;
+}
+
+/* Pipcall locking */
+void api_lock();
+void api_unlock();
+uint32_t api_lock_stat(uint32_t contended);
+
 /* Farcalls to API methods */
 extern bool createPartitionGlue(uint32_t ref, uint32_t pd, uint32_t sh1, uint32_t sh2, uint32_t sh3) ;
 
@@ -9,6 +9,8 @@
 #include <stdint.h>
 
 #include "debug.h"
+#include "pipstat.h"
+#include "gdt.h"
 
 #define UDELAY(x) delay_loop(100 * x) 
 
@@ -205,6 +207,9 @@ void init_mp_legacy()
 
 #define SMP_REQUEST_COREID      0
 #define SMP_REQUEST_CORECOUNT   1
+#define SMP_REQUEST_LOCKTAKEN   2
+#define SMP_REQUEST_LOCKSPUN    3
+#define SMP_REQUEST_PIPCALLSTAT 4
 
 /* Generic callgate for SMP requests (core id, core count etc) */
 uint32_t smpRequest(uint32_t requestId, uint32_t parameter)
@@ -217,6 +222,15 @@ uint32_t smpRequest(uint32_t requestId, uint32_t parameter)
         case SMP_REQUEST_CORECOUNT:
             return coreCount();
             break;
+        case SMP_REQUEST_LOCKTAKEN:
+            return api_lock_stat(0);
+            break;
+        case SMP_REQUEST_LOCKSPUN:
+            return api_lock_stat(1);
+            break;
+        case SMP_REQUEST_PIPCALLSTAT:
+            return pipcallStatQuery(parameter);
+            break;
         default:
             return 0;
     }
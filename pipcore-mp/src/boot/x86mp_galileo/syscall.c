@@ -7,7 +7,6 @@
 extern void init_msr(uint32_t st);
 extern uint32_t *_sysenter_stacks;
 
-#define PIPCALL_COUNT   20
 /* System calls */
 extern uint32_t createPartition(uint32_t,uint32_t,uint32_t,uint32_t,uint32_t);
 extern uint32_t countToMap(uint32_t,uint32_t);
@@ -20,6 +19,9 @@ extern uint32_t deletePartition(uint32_t);
 extern uint32_t collect(uint32_t,uint32_t);
 extern uint32_t smpRequest(uint32_t, uint32_t);
 extern uint32_t dispatchGlue(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+extern uint32_t mapRangeGlue(uint32_t, uint32_t, uint32_t, uint32_t, uint32_t);
+extern uint32_t unmapRangeGlue(uint32_t, uint32_t, uint32_t);
+extern uint32_t traceDrainGlue(uint32_t, uint32_t, uint32_t);
 
 extern uint32_t outbGlue(uint32_t, uint32_t);
 extern uint32_t outwGlue(uint32_t, uint32_t);
@@ -55,6 +57,18 @@ void *syscall_table[PIPCALL_COUNT] =
     &inlGlue,
     &outaddrlGlue,
     &slputs_sync,
+    &mapRangeGlue,
+    &unmapRangeGlue,
+    &traceDrainGlue,
+};
+
+/* Calls that only read state run without the pipcall lock, as their
+ * CG_GLUE_NOLOCK callgates do */
+uint8_t syscall_nolock[PIPCALL_COUNT] =
+{
+    [PIPCALL_COUNTTOMAP] = 1,
+    [PIPCALL_MAPPEDINCHILD] = 1,
+    [PIPCALL_SMPREQUEST] = 1,
 };
 
 void toto(){
@@ -1,26 +1,30 @@
 [GLOBAL init_msr]
 [EXTERN syscall_table]
+[EXTERN syscall_nolock]
 [EXTERN sysenter_c_ep]
 [EXTERN saveCallgateCaller]
 [EXTERN api_lock]
 [EXTERN api_unlock]
+[EXTERN pipcallStatEnter]
+[EXTERN pipcallStatLeave]
 [GLOBAL acquire]
 [GLOBAL release]
 
-api_spinlock: dd 0
-
+; Same locks as the callgates (see api_lock in gdt.c), keeping ECX/EDX
 acquire:
-    mov eax, api_spinlock       ; Spinlock address
-    bt dword [eax], 0            ; Check spinlock state
-    jc acquire                  ; If not, spin
-    lock bts dword [eax], 0      ; Lock
-    jc acquire                  ; Locking failed, spin
-acquire_ret:
+    push ecx
+    push edx
+    call api_lock
+    pop edx
+    pop ecx
     ret
 
 release:
-    mov eax, api_spinlock
-    btr dword [eax], 0           ; Release lock
+    push ecx
+    push edx
+    call api_unlock
+    pop edx
+    pop ecx
     ret
 
 sysenter_ep:
@@ -29,8 +33,18 @@ sysenter_ep:
     push ecx ; User ESP
 
 sysenter_lock:
-    ; Spinlock
+    ; Spinlock, but for the calls in syscall_nolock and the ones refused below
+    push eax
+    cmp ecx, 0x701000
+    jbe sysenter_locked
+    mov eax, [ecx + 0x8]
+    cmp eax, 0x17
+    jae sysenter_locked
+    cmp byte [syscall_nolock + eax], 0
+    jne sysenter_locked
     call acquire
+sysenter_locked:
+    pop eax
 
 sysenter_save_caller:
     ; Save caller info
@@ -54,7 +68,7 @@ sysenter_start_call:
     mov ebx, [ebx + 0x8] ; First parameter
 
     ; Check system call number
-    cmp ebx, 0x14   ; Check our syscall number doesn't exceed maximum system call id
+    cmp ebx, 0x17   ; Check our syscall number doesn't exceed maximum system call id
     mov eax, 0x0    ; "Zero" default return value
     jae back_to_userland    ; If higher or equal, get back to userland
 
@@ -62,6 +76,14 @@ sysenter_start_call:
     cmp ecx, 0x701000    ; Check we are indeed in a userland stack
     jbe back_to_userland ; If we're not, cancel call at once
 
+sysenter_stat:
+    ; Count the call and start timing it, keeping EBX/ECX
+    push ecx
+    push ebx
+    call pipcallStatEnter
+    pop ebx
+    pop ecx
+
 sysenter_copy:
     ; Prepare for syscall
     std             ; Set direction flag
@@ -94,6 +116,11 @@ sysenter_call:
     ; Fix stack by virtually pop'ing the 6 parameters
     add esp, 0x18
 
+    ; Stop timing, keeping EAX
+    push eax
+    call pipcallStatLeave
+    pop eax
+
 back_to_userland:
     ; Restore caller info
     pop edi
@@ -102,7 +129,7 @@ back_to_userland:
     pop ecx ; Retrieve user EIP
     pop edx ; Retrieve user ESP
     push eax
-    call release
+    call release    ; Only if taken above
     pop eax
     sti
     sysexit
@@ -83,15 +83,17 @@ void esp8266_hard_reset()
 
 /*
  * sends the tcp header
+ * @param link 0 to ESP8266_MAX_LINKS-1
  * @param length_int 2048 max
  *
  * returns 1 if succeeded.
  */
-int esp8266_send_tcp_header(int length_int)
+int esp8266_send_tcp_header(int link, int length_int)
 {
 	int ret = 0;
 	char rcv_buf[20];
 	char length_string[10] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+	char link_string[3] = { 0, ',', 0};
 	char header_string[20] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
 
 	// test if length_int is less than the send max size and bigger than 0
@@ -100,13 +102,21 @@ int esp8266_send_tcp_header(int length_int)
 		return ret;
 	}
 
+	if( (link < 0) || (link >= ESP8266_MAX_LINKS) )
+	{
+		return ret;
+	}
+
 	// mettre le buffer � zero
 	memset(rcv_buf, 0, sizeof(rcv_buf));
 
 	// convert tcp paylaod length from int to string
 	itoa(length_int, length_string, 10);
 	// copy the header prefix in the header string
-	strcpy(header_string, ESP8266_AT_SEND_DATA_LINK0_PREFIX);
+	strcpy(header_string, ESP8266_AT_SEND_DATA_PREFIX);
+	// concatenate the link number and its comma
+	link_string[0] = '0' + link;
+	strcat(header_string, link_string);
 	// concatenate the header with the length string
 	strcat(header_string, length_string);
 	// send the header
@@ -0,0 +1,217 @@
+/*
+ * esp8266_at.c
+ *
+ * Streaming recognizer for the unsolicited ESP8266 AT responses.
+ *
+ * All the tokens are compiled once into a trie. Bytes are fed straight from
+ * the UART DMA ring and walk the trie one transition each, so a response is
+ * recognized in a single pass without copying it. Tokens match a line prefix,
+ * the event fires on the end of line, except for "> " and "+IPD," which are
+ * not followed by a newline and fire as soon as they are complete.
+ */
+
+#include <stdio.h>
+#include <esp8266_at.h>
+
+#ifndef ESP8266_AT_MAX_NODES
+#define ESP8266_AT_MAX_NODES			128
+#endif
+#define ESP8266_AT_NO_NODE				0		// the root is never a child
+#define ESP8266_AT_DEAD					0xFF	// no token matches the current line
+
+// node indexes are uint8_t and must never read as ESP8266_AT_DEAD
+#if ESP8266_AT_MAX_NODES > ESP8266_AT_DEAD
+#error "ESP8266_AT_MAX_NODES does not fit the uint8_t node indexes"
+#endif
+
+typedef struct
+{
+	char c;
+	uint8_t child;
+	uint8_t sibling;
+	uint8_t event;
+	uint8_t immediate;
+} esp8266_at_node_t;
+
+typedef struct
+{
+	const char *token;
+	uint8_t event;
+	uint8_t immediate;
+} esp8266_at_token_t;
+
+// "<link>," prefixing the connection tokens is skipped before the trie
+static const esp8266_at_token_t esp8266_at_tokens[] =
+{
+	{ "SEND OK",			ESP8266_AT_SEND_OK,			0 },
+	{ "SEND FAIL",			ESP8266_AT_SEND_FAIL,		0 },
+	{ "OK",					ESP8266_AT_OK,				0 },
+	{ "ERROR",				ESP8266_AT_ERROR,			0 },
+	{ "busy ",				ESP8266_AT_BUSY,			0 },
+	{ "Recv ",				ESP8266_AT_RECV,			0 },
+	{ "link is not valid",	ESP8266_AT_LINK_INVALID,	0 },
+	{ ",CONNECT",			ESP8266_AT_CONNECT,			0 },
+	{ ",CONNECT FAIL",		ESP8266_AT_CONNECT_FAIL,	0 },
+	{ ",CLOSED",			ESP8266_AT_CLOSED,			0 },
+	{ "WIFI CONNECTED",		ESP8266_AT_WIFI_CONNECTED,	0 },
+	{ "WIFI DISCONNECT",	ESP8266_AT_WIFI_DISCONNECT,	0 },
+	{ "WIFI GOT IP",		ESP8266_AT_WIFI_GOT_IP,		0 },
+	{ "> ",					ESP8266_AT_PROMPT,			1 },
+	{ "+IPD,",				ESP8266_AT_IPD,				1 },
+};
+
+static esp8266_at_node_t esp8266_at_trie[ESP8266_AT_MAX_NODES];
+static uint8_t esp8266_at_node_count = 0;
+
+static uint8_t esp8266_at_next(uint8_t node, char c)
+{
+	uint8_t child = esp8266_at_trie[node].child;
+
+	while(child != ESP8266_AT_NO_NODE && esp8266_at_trie[child].c != c)
+	{
+		child = esp8266_at_trie[child].sibling;
+	}
+
+	return child;
+}
+
+/*
+ * Builds the trie from esp8266_at_tokens.
+ *
+ * @return 0, or -1 if the tokens need more than ESP8266_AT_MAX_NODES nodes
+ */
+static int esp8266_at_compile()
+{
+	unsigned int i;
+	const char *c;
+	uint8_t node, next;
+
+	esp8266_at_node_count = 1;
+
+	for(i = 0; i < sizeof(esp8266_at_tokens) / sizeof(esp8266_at_tokens[0]); i++)
+	{
+		node = 0;
+		for(c = esp8266_at_tokens[i].token; *c; c++)
+		{
+			next = esp8266_at_next(node, *c);
+			if(next == ESP8266_AT_NO_NODE)
+			{
+				if(esp8266_at_node_count >= ESP8266_AT_MAX_NODES)
+				{
+					printf("esp8266_at: \"%s\" overflows the %d trie nodes\r\n", esp8266_at_tokens[i].token, ESP8266_AT_MAX_NODES);
+					esp8266_at_node_count = 0;
+					return -1;
+				}
+				next = esp8266_at_node_count++;
+				esp8266_at_trie[next].c = *c;
+				esp8266_at_trie[next].sibling = esp8266_at_trie[node].child;
+				esp8266_at_trie[node].child = next;
+			}
+			node = next;
+		}
+		esp8266_at_trie[node].event = esp8266_at_tokens[i].event;
+		esp8266_at_trie[node].immediate = esp8266_at_tokens[i].immediate;
+	}
+
+	return 0;
+}
+
+static void esp8266_at_new_line(esp8266_at_t *at)
+{
+	at->node = 0;
+	at->match = ESP8266_AT_NONE;
+	at->link = ESP8266_AT_NO_LINK;
+	at->length = 0;
+}
+
+/*
+ * Resets the line state, compiling the trie on the first call.
+ *
+ * @return 0, or -1 if the token table does not fit the trie
+ */
+int esp8266_at_init(esp8266_at_t *at)
+{
+	if(esp8266_at_node_count == 0 && esp8266_at_compile() != 0)
+	{
+		return -1;
+	}
+	esp8266_at_new_line(at);
+	return 0;
+}
+
+/*
+ * Feeds received bytes to the recognizer, stopping after the first event.
+ * The line state is kept across calls, so a response may be split anywhere.
+ * The link number of a connection event is left in at->link until the next
+ * call.
+ *
+ * @param (out) event the recognized event, ESP8266_AT_NONE if none
+ * @return the number of bytes used, the caller must not feed them again
+ */
+unsigned long esp8266_at_feed(esp8266_at_t *at, const char *data, unsigned long size, uint8_t *event)
+{
+	unsigned long i;
+	char c;
+
+	*event = ESP8266_AT_NONE;
+
+	for(i = 0; i < size; i++)
+	{
+		c = data[i];
+
+		if(c == '\r' || c == '\n')
+		{
+			if(at->length > 0)
+			{
+				*event = at->match != ESP8266_AT_NONE ? at->match : ESP8266_AT_UNKNOWN;
+				at->node = 0;
+				at->match = ESP8266_AT_NONE;
+				at->length = 0;
+				return i + 1;
+			}
+			continue;
+		}
+
+		if(at->length == 0)
+		{
+			at->link = ESP8266_AT_NO_LINK;
+			if(c >= '0' && c <= '9')
+			{
+				at->link = c - '0';
+				at->length = 1;
+				continue;
+			}
+		}
+		if(at->length < 0xFF)
+		{
+			at->length++;
+		}
+
+		if(at->node == ESP8266_AT_DEAD)
+		{
+			continue;
+		}
+
+		at->node = esp8266_at_next(at->node, c);
+		if(at->node == ESP8266_AT_NO_NODE)
+		{
+			at->node = ESP8266_AT_DEAD;
+			continue;
+		}
+
+		if(esp8266_at_trie[at->node].event != ESP8266_AT_NONE)
+		{
+			if(esp8266_at_trie[at->node].immediate)
+			{
+				*event = esp8266_at_trie[at->node].event;
+				at->node = 0;
+				at->match = ESP8266_AT_NONE;
+				at->length = 0;
+				return i + 1;
+			}
+			at->match = esp8266_at_trie[at->node].event;
+		}
+	}
+
+	return size;
+}
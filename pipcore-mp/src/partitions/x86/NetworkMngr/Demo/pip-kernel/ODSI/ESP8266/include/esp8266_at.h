@@ -0,0 +1,45 @@
+/*
+ * esp8266_at.h
+ *
+ * Streaming recognizer for the unsolicited ESP8266 AT responses
+ */
+
+#ifndef ESP8266_INCLUDE_ESP8266_AT_H_
+#define ESP8266_INCLUDE_ESP8266_AT_H_
+
+#include <stdint.h>
+
+// events emitted by esp8266_at_feed
+#define ESP8266_AT_NONE					0
+#define ESP8266_AT_OK					1		// "OK"
+#define ESP8266_AT_ERROR				2		// "ERROR"
+#define ESP8266_AT_SEND_OK				3		// "SEND OK"
+#define ESP8266_AT_SEND_FAIL			4		// "SEND FAIL"
+#define ESP8266_AT_BUSY					5		// "busy s..." or "busy p..."
+#define ESP8266_AT_RECV					6		// "Recv <nbre_of_bytes> bytes"
+#define ESP8266_AT_LINK_INVALID			7		// "link is not valid"
+#define ESP8266_AT_CONNECT				8		// "<link>,CONNECT"
+#define ESP8266_AT_CONNECT_FAIL			9		// "<link>,CONNECT FAIL"
+#define ESP8266_AT_CLOSED				10		// "<link>,CLOSED"
+#define ESP8266_AT_WIFI_CONNECTED		11		// "WIFI CONNECTED"
+#define ESP8266_AT_WIFI_DISCONNECT		12		// "WIFI DISCONNECT"
+#define ESP8266_AT_WIFI_GOT_IP			13		// "WIFI GOT IP"
+#define ESP8266_AT_PROMPT				14		// "> ", not followed by a newline
+#define ESP8266_AT_IPD					15		// "+IPD,", the segment header follows
+#define ESP8266_AT_UNKNOWN				16		// any other non empty line
+
+// no link number seen on the current line
+#define ESP8266_AT_NO_LINK				0xFF
+
+typedef struct
+{
+	uint8_t node;		// current trie node, 0 is the line start
+	uint8_t match;		// event of the longest token matched on this line
+	uint8_t link;		// link number prefixing the current line
+	uint8_t length;		// bytes seen on the current line
+} esp8266_at_t;
+
+int esp8266_at_init(esp8266_at_t *at);
+unsigned long esp8266_at_feed(esp8266_at_t *at, const char *data, unsigned long size, uint8_t *event);
+
+#endif /* ESP8266_INCLUDE_ESP8266_AT_H_ */
@@ -11,6 +11,7 @@
 #include "domains.h"
 #include "UART_DMA.h"
 #include "esp8266.h"
+#include "esp8266_at.h"
 #include "Quark_x1000_support.h"
 #include "Galileo_Gen2_Board.h"
 #include "CommonStructure.h"
@@ -35,23 +36,11 @@
 #include <pip/compat.h>
 
 // static function prototypes
-static int dispatch_message_to_domain(QueueHandle_t xQueue_domains_array[], event_t *p_EventRequest, uint32_t size_in);
-static int rcv_tcp_segment(char *rcv_buf);
-static int check_send_ok(char *rcv_buf);
-static int check_send_fail(char *rcv_buf);
-static int check_esp8266_received_data(char *rcv_buf);
+static int dispatch_message_to_domain(QueueHandle_t xQueue_domains_array[], const ext_frame_t *frame);
+static void rcv_tcp_segment();
+static void handle_esp8266_event(uint8_t event);
 static void read_from_esp8266();
-static int check_esp8266_busy(char *rcv_buf);
-static int check_esp8266_error(char *rcv_buf);
-static int check_client_connect(char *rcv_buf);
-static int check_client_connect_fail(char *rcv_buf);
-static int check_esp8266_ok(char *rcv_buf);
-static int check_esp8266_ready_to_send_tcp_payload(char *rcv_buf);
-static int check_client_disconnect(char *rcv_buf);
-static int check_wifi_connected(char *rcv_buf);
-static int check_wifi_disconnect(char *rcv_buf);
-static int check_wifi_got_ip(char *rcv_buf);
-static int link_is_not_valid(char *rcv_buf);
+static uint32_t nw_wait_event(QueueHandle_t xQueue_2NW, event_t *ICEvent);
 
 // static variables
 static uint8_t esp8266_responsive = 1;
@@ -68,6 +57,43 @@ static uint8_t esp8266_ready_to_send_tcp_payload = 0;
 static uint8_t waiting_tcp_header_reception_ack = 0;
 static uint8_t v_link_is_not_valid = 0;
 static uint8_t fatal_error = 0;
+static esp8266_at_t esp8266_at;
+
+/*
+ * Single wait point of the Network Manager.
+ * The UART DMA ring has no interrupt and the outbound queue lives in the root,
+ * so there is nothing to block on for both at once: the ring is checked first
+ * (a plain MMIO read), and only when it is empty the task sleeps once in the
+ * root on the outbound queue for at most NW_WAIT_TICKS. The send state
+ * machine still runs on timeout so a pending header gets retried.
+ * Returns the NW_EVENT_* bits that fired, 0 on timeout.
+ */
+static uint32_t nw_wait_event(QueueHandle_t xQueue_2NW, event_t *ICEvent)
+{
+	uint32_t events = 0;
+	TickType_t wait = NW_WAIT_TICKS;
+
+	if(vGalileo_UART0_is_data_available())
+	{
+		// something to do anyway, only peek at the outbound queue
+		events |= NW_EVENT_UART;
+		wait = 0;
+	}
+
+	if( xQueue_2NW != 0 &&
+		xProtectedQueueReceive( (uint32_t)xQueue_2NW, (uint32_t)ICEvent, wait ) )
+	{
+		events |= NW_EVENT_OUTBOUND;
+	}
+
+	// the esp8266 may have answered while we were sleeping
+	if(wait && vGalileo_UART0_is_data_available())
+	{
+		events |= NW_EVENT_UART;
+	}
+
+	return events;
+}
 
 void NW_Task( uint32_t *pvParameters )
 {
@@ -79,12 +105,13 @@ void NW_Task( uint32_t *pvParameters )
 	xQueue_domains_array[3] = (QueueHandle_t) pvParameters[4];
 
 	event_t *ICEvent = (event_t *) allocPage();
-	event_t *EventRequest = (event_t *) allocPage();
+	ext_frame_t frames[NW_MAX_FRAMES];
 
 	printf("ICEvent : %x\r\n", ICEvent);
-	printf("EventRequest : %x\r\n", EventRequest);
 
-	uint32_t size_in = 0, sizeout = 0;
+	uint32_t frame_count = 0, sizeout = 0;
+	uint32_t events = 0;
+	uint32_t i;
 
 	void* ServerSocket = NULL;
 	void* ClientSocket = NULL;
@@ -125,47 +152,49 @@ void NW_Task( uint32_t *pvParameters )
 		wifi_connected = 1;
 		wifi_got_ip = 1;
 
+		if(esp8266_at_init(&esp8266_at) != 0)
+		{
+			printf("AT recognizer does not fit, stopping the network manager\r\n");
+			for(;;);
+		}
+
 		while(esp8266_responsive && l_result && !fatal_error)
 		{
-			printf("receive and dispatch arrived data if any\r\n");
+			events = nw_wait_event(xQueue_2NW, ICEvent);
+
 			/*
-			 * receive and dispatch arrived data if any
+			 * read esp8266 feed via UART and update states.
 			 */
-			//memset(InValue, 0, IN_MAX_MESSAGE_SIZE*sizeof(char));
-			// TODO remove the IN_MAX_MESSAGE_SIZE bytes receive limit using receive FIFO
-			size_in = ext_receive(ClientSocket, EventRequest->eventData.nw.stream);
-			if(size_in > 0)
+			if(events & NW_EVENT_UART)
 			{
-				EventRequest->eventType = NW_IN;
-				EventRequest->eventData.nw.size=size_in;
-				// dispatch
-				printf("[Network Manager] dispatch_message_to_domain\r\n");
-				dispatch_message_to_domain(xQueue_domains_array, EventRequest, size_in);
-				printf("Back from dispatch message to domain !!!\r\n");
+				read_from_esp8266();
 			}
 
 			/*
-			 * send data if any
+			 * receive and dispatch arrived data if any,
+			 * requests of every link are dispatched without waiting for the responses
 			 */
-			if( xQueue_2NW != 0 )
+			do
 			{
-				/* Receive Response data
-				 * Don't block if nothing to read. */
-				printf("[Network Manager] xQueueReceive( xQueue_2NW, ICEvent...\r\n");
-				if( xProtectedQueueReceive( (uint32_t)xQueue_2NW, (uint32_t)ICEvent, ( TickType_t ) 0 ) )
+				frame_count = ext_receive_frames(ClientSocket, frames, NW_MAX_FRAMES);
+				for(i = 0; i < frame_count; i++)
 				{
-					if(ICEvent->eventType == NW_OUT)
-					{
-						printf("[Network Manager] ext_send(...\r\n");
-						ext_send(ClientSocket, ICEvent->eventData.nw.stream, ICEvent->eventData.nw.size);
-					}
+					dispatch_message_to_domain(xQueue_domains_array, &frames[i]);
 				}
+				ext_release_frames(ClientSocket);
+			} while(frame_count == NW_MAX_FRAMES);
+
+			/*
+			 * queue outbound data if any
+			 */
+			if((events & NW_EVENT_OUTBOUND) && ICEvent->eventType == NW_OUT)
+			{
+				ext_send(ClientSocket, ICEvent->eventData.nw.stream, ICEvent->eventData.nw.size, ICEvent->link);
 			}
 
 			/*
 			 * send tcp header if any
 			 */
-			printf("[Network Manager] send tcp header if any\r\n");
 			if(		client_connected && wifi_connected && wifi_got_ip &&
 					!sending_tcp_payload  && !waiting_tcp_header_reception_ack)
 			{
@@ -222,12 +251,6 @@ void NW_Task( uint32_t *pvParameters )
 				// Pull the item successfully sent from the tcp send fifo
 				remove_tcp_payload_from_send_fifo(sizeout);
 			}
-
-			/*
-			 * read esp8266 feed via UART and update states.
-			 */
-			read_from_esp8266();
-
 		}
 		mycloseSocket(ClientSocket);
 	}
@@ -238,543 +261,101 @@ void NW_Task( uint32_t *pvParameters )
  * This function read the feed from esp8266 UART communication.
  * It updated the global state variables like client_connected, wifi_got_ip (wifi_disconnect) and esp8266_busy etc...
  * In case of tcp segment arrival it calls specific function to do the necessary.
- * This function returns if nothing to read.
+ * The DMA ring is fed to the AT recognizer in place, this function returns once it is empty.
  */
 static void read_from_esp8266()
 {
-	char rcv_buf[100];
-
-	// mettre le buffer � zero
-	memset(rcv_buf, 0, sizeof(rcv_buf));
-
-	int read_size = 0;
-
-	if(vGalileo_UART0_is_data_available())
-	{
-		// read only 2 characters (Maybe "> ")
-		read_size = vGalileo_UART0_read_line(rcv_buf, 2);
-	}
-
-	// returns if nothing to read
-	if(read_size < 1)
-	{
-		return;
-	}
-
-
-	/*
-	 * MUST be the first test (Mandatory) because it doesn't end with newline !!!
-	 */
-	if(read_size == 2)
-	{
-		/*
-		 * check if it is a "> " then return if yes
-		 */
-		if(check_esp8266_ready_to_send_tcp_payload(rcv_buf))
-		{
-			esp8266_ready_to_send_tcp_payload = 1;
-			return;
-		}
-		else
-		{
-			if(vGalileo_UART0_is_data_available())
-			{
-				// try to read only 3 more characters (Maybe "+IPD,")
-				read_size += vGalileo_UART0_read_line(&(rcv_buf[2]), 3);
-			}
-		}
-	}
-
-	/*
-	 * MUST be the second test (Mandatory) because it doesn't end with newline !!!
-	 */
-	if(read_size == 5)
-	{
-		// check if it is a tcp segment reception then return if yes
-		int ret = rcv_tcp_segment(rcv_buf);
-		printf("return from rcv_tcp_segment\r\n");
-		if(ret)
-		{
-			return;
-		}
-		else
-		{
-			if(vGalileo_UART0_is_data_available())
-			{
-				// try to continue line reading if it wasn't a tcp segment reception and read_size == 5
-				read_size += vGalileo_UART0_read_line(&(rcv_buf[5]), sizeof(rcv_buf) - 5);
-			}
-		}
-	}
-
-	/*
-	 * The tests below are sorted in occurrence probability order in order to increase performance.
-	 */
-
-	/*
-	 * check if it is a send ok then return if yes
-	 */
-	if( read_size == 7 )
-	{
-		if(check_send_ok(rcv_buf))
-		{
-			// update states
-			send_ok = 1;
-			return;
-		}
-	}
-
-	/*
-	 * check if it is a send fail then return if yes
-	 */
-	if( read_size == 9 )
-	{
-		if(check_send_fail(rcv_buf))
-		{
-			send_fail = 1;
-			return;
-		}
-	}
-
-	/*
-	 * check if esp8266 received data for send and return if yes
-	 */
-	if( read_size >= 12 && read_size <= 15 )
-	{
-		if(check_esp8266_received_data(rcv_buf))
-		{
-			return;
-		}
-	}
-
-	/*
-	 * check if esp8266 is busy then return if yes
-	 */
-	if( read_size == 9 )
-	{
-		if(check_esp8266_busy(rcv_buf))
-		{
-			esp8266_busy = 1;
-			return;
-		}
-	}
-
-	/*
-	 * check if it is an ERROR then return if yes
-	 */
-	if( read_size == 5 )
-	{
-		if(check_esp8266_error(rcv_buf))
-		{
-			error = 1;
-			return;
-		}
-	}
-
-	/*
-	 * check if link is not valid then return if yes
-	 */
-	if( read_size == 5 )
-	{
-		if(link_is_not_valid(rcv_buf))
-		{
-			// update states
-			v_link_is_not_valid = 1;
-			return;
-		}
-	}
-
-	/*
-	 * check if it is a client connection then return if yes
-	 */
-	if( read_size == 9 )
-	{
-		if(check_client_connect(rcv_buf))
-		{
-			client_connected = 1;
-			return;
-		}
-	}
-
-	/*
-	 * check if it is a client connection fail then return if yes
-	 */
-	if( read_size == 14 )
-	{
-		if(check_client_connect_fail(rcv_buf))
-		{
-			client_connected = 0;
-			return;
-		}
-	}
-
-	/*
-	 * check if it is a "OK" then return if yes
-	 */
-	if( read_size == 2 )
-	{
-		if(check_esp8266_ok(rcv_buf))
-		{
-			got_ok = 1;
-			return;
-		}
-	}
-
-	/*
-	 * check if it is a client disconnection then return if yes
-	 */
-	if( read_size == 8 )
-	{
-		if(check_client_disconnect(rcv_buf))
-		{
-			client_connected = 0;
-			return;
-		}
-	}
-
-	/*
-	 * check if it is a wifi connection then return if yes
-	 */
-	if( read_size == 14 )
-	{
-		if(check_wifi_connected(rcv_buf))
-		{
-			wifi_connected = 1;
-			return;
-		}
-	}
-
-	/*
-	 * check if it is a wifi disconnection then return if yes
-	 */
-	if( read_size == 15 )
-	{
-		if(check_wifi_disconnect(rcv_buf))
-		{
-			wifi_connected = 0;
-			wifi_got_ip = 0;
-			return;
-		}
-	}
-
-	/*
-	 * check if it is a wifi got ip then return if yes
-	 */
-	if( read_size == 11 )
-	{
-		if(check_wifi_got_ip(rcv_buf))
-		{
-			wifi_got_ip = 1;
-			return;
-		}
-	}
-
-	// we shouldn't arrive here
-	fatal_error = 1;
-}
-
-/*
- * try to receive tcp segement if any.
- *
- * returns 1 if succeeded
- */
-static int rcv_tcp_segment(char *rcv_buf)
-{
-	int ret = 0;
+	const char *span;
+	unsigned long size, used;
+	uint8_t event;
 
-	// check if receiving TCP segment (+IPD)
-	if(esp8266_check_IPD_reception(rcv_buf))
+	while(!fatal_error && (size = uart0_dma_peek(&span)) > 0)
 	{
-		ret = 1;
-
-		unsigned int received_bytes_count = 0;
-		// continue reading the rest of the TCP header
-		printf("get_tcp_header\r\n");
-		received_bytes_count = esp8266_get_tcp_header(NULL);
+		used = esp8266_at_feed(&esp8266_at, span, size, &event);
+		uart0_dma_consume(used);
 
-		if(received_bytes_count > 0)
+		if(event != ESP8266_AT_NONE)
 		{
-			printf("get_tcp_payload: %d\r\n", received_bytes_count);
-			// read TCP segment payload
-			esp8266_get_tcp_payload(received_bytes_count);
+			handle_esp8266_event(event);
 		}
 	}
-
-	return ret;
-}
-
-/*
- * check "SEND OK" reception
- *
- * returns 1 if succeeded
- */
-static int check_send_ok(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received "SEND OK"
-	if(esp8266_response_contains(rcv_buf, "SEND OK"))
-	{
-		DEBUG(TRACE, "[ESP8266] SEND OK\r\n");
-		ret = 1;
-	}
-
-	return ret;
 }
 
 /*
- * check "SEND FAIL" reception
- *
- * returns 1 if succeeded
+ * Updates the states according to an AT response of the esp8266
  */
-static int check_send_fail(char *rcv_buf)
+static void handle_esp8266_event(uint8_t event)
 {
-	int ret = 0;
-
-	// test if we received "SEND FAIL"
-	if(esp8266_response_contains(rcv_buf, "SEND FAIL"))
+	switch(event)
 	{
-		DEBUG(TRACE, "[ESP8266] SEND FAIL\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * TODO detect if "busy s..." or "busy p..."
- * check "busy s..." or "busy p..." reception
- *
- * returns 1 if succeeded
- */
-static int check_esp8266_busy(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received "busy s..." or "busy p..."
-	if(esp8266_response_contains(rcv_buf, "busy"))
-	{
-		DEBUG(TRACE, "[ESP8266] busy\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * check "ERROR" reception
- *
- * returns 1 if succeeded
- */
-static int check_esp8266_error(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received "ERROR"
-	if(esp8266_response_contains(rcv_buf, "ERROR"))
-	{
-		DEBUG(TRACE, "[ESP8266] ERROR\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * check "link is not valid" reception
- *
- * returns 1 if succeeded
- */
-static int link_is_not_valid(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received "link is not valid"
-	if(esp8266_response_contains(rcv_buf, "link is not valid"))
-	{
-		DEBUG(TRACE, "[ESP8266] link is not valid\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * TODO check the link number
- * check ",CONNECT" reception
- *
- * returns 1 if succeeded
- */
-static int check_client_connect(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received ",CONNECT"
-	if(esp8266_response_contains(&(rcv_buf[1]), ",CONNECT"))
-	{
-		DEBUG(TRACE, "[ESP8266] client ,CONNECT\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * TODO check the link number
- * check ",CONNECT FAIL" reception
- *
- * returns 1 if succeeded
- */
-static int check_client_connect_fail(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received ",CONNECT FAIL"
-	if(esp8266_response_contains(&(rcv_buf[1]), ",CONNECT FAIL"))
-	{
-		DEBUG(TRACE, "[ESP8266] client ,CONNECT FAIL\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * TODO remove code duplication compare with manageNW_Simple.c !!!
- * check "OK" reception
- *
- * returns 1 if succeeded
- */
-static int check_esp8266_ok(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received "OK"
-	if(esp8266_response_contains(rcv_buf, "OK"))
-	{
-		DEBUG(TRACE, "[ESP8266] OK\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * check "> " reception
- *
- * returns 1 if succeeded
- */
-static int check_esp8266_ready_to_send_tcp_payload(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received "> "
-	if(esp8266_response_contains(rcv_buf, "> "))
-	{
-		DEBUG(TRACE, "[ESP8266] ><space>\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * TODO check the link number
- * check ",CLOSED" reception
- *
- * returns 1 if succeeded
- */
-static int check_client_disconnect(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received ",CLOSED"
-	if(esp8266_response_contains(&(rcv_buf[1]), ",CLOSED"))
-	{
-		DEBUG(TRACE, "[ESP8266] client ,CLOSED\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * TODO remove code duplication compare with manageNW_Simple.c !!!
- * check "WIFI CONNECTED" reception
- *
- * returns 1 if succeeded
- */
-static int check_wifi_connected(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received "WIFI CONNECTED"
-	if(esp8266_response_contains(rcv_buf, "WIFI CONNECTED"))
-	{
-		DEBUG(TRACE, "[ESP8266] WIFI CONNECTED\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
-
-/*
- * TODO remove code duplication compare with manageNW_Simple.c !!!
- * check "WIFI DISCONNECT" reception
- *
- * returns 1 if succeeded
- */
-static int check_wifi_disconnect(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received "WIFI DISCONNECT"
-	if(esp8266_response_contains(rcv_buf, "WIFI DISCONNECT"))
-	{
-		DEBUG(TRACE, "[ESP8266] WIFI DISCONNECT\r\n");
-		ret = 1;
+	case ESP8266_AT_PROMPT:
+		esp8266_ready_to_send_tcp_payload = 1;
+		break;
+	case ESP8266_AT_IPD:
+		rcv_tcp_segment();
+		break;
+	case ESP8266_AT_SEND_OK:
+		send_ok = 1;
+		break;
+	case ESP8266_AT_SEND_FAIL:
+		send_fail = 1;
+		break;
+	case ESP8266_AT_RECV:
+		break;
+	case ESP8266_AT_BUSY:
+		esp8266_busy = 1;
+		break;
+	case ESP8266_AT_ERROR:
+		error = 1;
+		break;
+	case ESP8266_AT_LINK_INVALID:
+		v_link_is_not_valid = 1;
+		break;
+	case ESP8266_AT_CONNECT:
+		esp8266_link_connected(esp8266_at.link);
+		client_connected = esp8266_links_connected() > 0;
+		break;
+	case ESP8266_AT_CONNECT_FAIL:
+	case ESP8266_AT_CLOSED:
+		esp8266_link_closed(esp8266_at.link);
+		client_connected = esp8266_links_connected() > 0;
+		break;
+	case ESP8266_AT_OK:
+		got_ok = 1;
+		break;
+	case ESP8266_AT_WIFI_CONNECTED:
+		wifi_connected = 1;
+		break;
+	case ESP8266_AT_WIFI_DISCONNECT:
+		wifi_connected = 0;
+		wifi_got_ip = 0;
+		break;
+	case ESP8266_AT_WIFI_GOT_IP:
+		wifi_got_ip = 1;
+		break;
+	default:
+		// we shouldn't arrive here
+		DEBUG(TRACE, "[ESP8266] unexpected response\r\n");
+		fatal_error = 1;
 	}
-
-	return ret;
 }
 
 /*
- * TODO remove code duplication compare with manageNW_Simple.c !!!
- * check "WIFI GOT IP" reception
- *
- * returns 1 if succeeded
+ * receive the tcp segment announced by "+IPD,"
  */
-static int check_wifi_got_ip(char *rcv_buf)
+static void rcv_tcp_segment()
 {
-	int ret = 0;
+	unsigned int received_bytes_count = 0;
+	uint32_t link = 0;
 
-	// test if we received "WIFI GOT IP"
-	if(esp8266_response_contains(rcv_buf, "WIFI GOT IP"))
-	{
-		DEBUG(TRACE, "[ESP8266] WIFI GOT IP\r\n");
-		ret = 1;
-	}
-
-	return ret;
-}
+	// continue reading the rest of the TCP header
+	received_bytes_count = esp8266_get_tcp_header(&link);
 
-/*
- * check "Recv <nbre_of_bytes> bytes" reception
- *
- * returns 1 if succeeded
- */
-static int check_esp8266_received_data(char *rcv_buf)
-{
-	int ret = 0;
-
-	// test if we received "Recv <nbre_of_bytes> bytes"
-	if(esp8266_response_contains(rcv_buf, "Recv "))
+	if(received_bytes_count > 0)
 	{
-		DEBUG(TRACE, "[ESP8266] Recv <nbre_of_bytes> bytes\r\n");
-		ret = 1;
+		// read TCP segment payload
+		esp8266_get_tcp_payload(link, received_bytes_count);
 	}
-
-	return ret;
 }
 
 /*
@@ -784,7 +365,7 @@ static int check_esp8266_received_data(char *rcv_buf)
  *
  * return 1 if succeeded
  */
-static int dispatch_message_to_domain(QueueHandle_t xQueue_domains_array[], event_t *p_EventRequest, uint32_t size_in)
+static int dispatch_message_to_domain(QueueHandle_t xQueue_domains_array[], const ext_frame_t *frame)
 {
 	int ret = 0;
 	event_t *EventToDisptach = allocPage();
@@ -801,9 +382,9 @@ static int dispatch_message_to_domain(QueueHandle_t xQueue_domains_array[], even
 	QueueHandle_t xQueue_2SP3D_IC = xQueue_domains_array[3];
 
 	// deserialize the incoming message
-	EventToDisptach->eventData.incomingMessage = deserialize_incomingMessage(p_EventRequest->eventData.nw.stream, size_in);
-	printf("Back from deserialize\r\n");
+	EventToDisptach->eventData.incomingMessage = deserialize_incomingMessage((char *) frame->data, frame->size);
 	EventToDisptach->eventType = EXT_MESSAGE;
+	EventToDisptach->link = frame->link;
 
 	// send the message to corresponding domain if any.
 	switch(EventToDisptach->eventData.incomingMessage.domainID)
@@ -846,7 +427,5 @@ static int dispatch_message_to_domain(QueueHandle_t xQueue_domains_array[], even
 
 	freePage(EventToDisptach);
 
-	printf("just before return from dispatch message to domain\r\n");
-
 	return ret;
 }
@@ -8,6 +8,16 @@
 #ifndef NWMANAGER_NWMANAGER_H_
 #define NWMANAGER_NWMANAGER_H_
 
+/* Longest sleep of NW_Task in the root while the UART ring stays empty */
+#define NW_WAIT_TICKS		5
+
+/* Events returned by the NW_Task wait point */
+#define NW_EVENT_UART		(1 << 0)
+#define NW_EVENT_OUTBOUND	(1 << 1)
+
+/* Frames NW_Task takes from the receive fifos at once */
+#define NW_MAX_FRAMES		8
+
 void NW_Task( uint32_t *pvParameters );
 
 #endif /* NWMANAGER_NWMANAGER_H_ */
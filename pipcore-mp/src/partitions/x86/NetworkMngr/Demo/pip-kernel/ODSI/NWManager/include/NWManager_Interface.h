@@ -15,6 +15,20 @@
 #include "task.h"
 #include "semphr.h"
 
+// frames sent by the clients: "ODSI" <payload size, 4 bytes> <payload>
+#define ODSI_FRAME_MAGIC			"ODSI"
+#define ODSI_FRAME_HEADER_SIZE		8
+
+/*
+ * A received frame payload, left in place in the receive fifo of its link
+ */
+typedef struct
+{
+	uint32_t link;
+	const char *data;
+	uint32_t size;
+} ext_frame_t;
+
 /**
  * Initializes ListenSocket with TCP/IP address & port
  * @return ListenSocket
@@ -41,16 +55,24 @@ void* get_connection(void* ListenSocket);
  * @param ClientSocket
  * @param outData
  * @param size
+ * @param link ESP8266 link of the client
  */
-void ext_send(void* ClientSocket, char* outData, uint32_t size);
+void ext_send(void* ClientSocket, char* outData, uint32_t size, uint32_t link);
 
 /**
- * Receive until the peer shuts down the connection
+ * Receive the complete frames of every client, without copying them
  * @param ClientSocket
- * @param data
- * @return
+ * @param frames (out) views of the frame payloads
+ * @param max_frames
+ * @return the number of frames, valid until ext_release_frames
  */
-uint32_t ext_receive(void* ClientSocket, char* data);
+uint32_t ext_receive_frames(void* ClientSocket, ext_frame_t *frames, uint32_t max_frames);
+
+/**
+ * Release the frames returned by ext_receive_frames
+ * @param ClientSocket
+ */
+void ext_release_frames(void* ClientSocket);
 
 /**
  * Close the socket
@@ -69,22 +91,30 @@ int esp8266_check_IPD_reception(char *rcv_buf);
 /*
  * Attempts to read TCP header
  *
- * @param header point to an array of 12 bytes minimum in order to hold the header
+ * @param (out) link the link the segment was received on
  * @return the payload size of tcp segment
  */
-unsigned int esp8266_get_tcp_header(char *header);
+unsigned int esp8266_get_tcp_header(uint32_t *link);
 
 /*
  * attempts to get tcp payload of the received tcp segment from the ESP8266 module
+ * and pushes it in the receive fifo of the link
  *
- * @param (out) payload point to an array in order to hold the payload
+ * @param (in) link the link the segment was received on
  * @param (in) payload size
  * @return payload size
  */
-int esp8266_get_tcp_payload(unsigned int payload_size);
+int esp8266_get_tcp_payload(uint32_t link, unsigned int payload_size);
 
 uint32_t try_to_send_tcp_header();
 void send_tcp_payload(uint32_t size);
 void remove_tcp_payload_from_send_fifo(uint32_t size);
 
+/*
+ * Link table, updated on "<link>,CONNECT" and "<link>,CLOSED"
+ */
+void esp8266_link_connected(uint32_t link);
+void esp8266_link_closed(uint32_t link);
+uint32_t esp8266_links_connected();
+
 #endif /* NWMANAGER_INCLUDE_NWMANAGER_INTERFACE_H_ */
@@ -40,7 +40,7 @@ static int esp8266_test_serial_comm();
 static int esp8266_disable_echoing();
 static int esp8266_disable_transparent_transmission();
 static int esp8266_enable_multiple_connections();
-static int esp8266_set_maximum_connections_to_one();
+static int esp8266_set_maximum_connections();
 static int esp8266_create_tcp_server_port_8080();
 static int esp8266_set_tcp_srv_timeout(unsigned int timeout);
 static int esp8266_hide_remote_IP_port_with_IPD();
@@ -50,8 +50,26 @@ static char esp8266_get_link_number();
 
 static int esp8266_send_tcp_payload(char *payload, unsigned int payload_size);
 
-static fifo_t tcp_rcv_fifo;
-static fifo_t tcp_send_fifo;
+static uint32_t odsi_find_magic(const char *data, uint32_t size);
+static uint32_t ext_receive_link(uint32_t link, ext_frame_t *frames, uint32_t max_frames);
+
+/*
+ * One entry per ESP8266 link (tcp client). Received segments and queued
+ * responses of a client never mix with the ones of another client.
+ */
+typedef struct
+{
+	uint8_t connected;
+	uint32_t rcv_consumed;		// bytes ext_release_frames drops from rcv_fifo
+	fifo_t rcv_fifo;
+	fifo_t send_fifo;
+} esp8266_link_t;
+
+static esp8266_link_t links[ESP8266_MAX_LINKS];
+// link of the segment being sent, the next header goes to the link after it
+static uint32_t send_link = 0;
+// link ext_receive looked at last
+static uint32_t rcv_link = 0;
 
 /*-----------------------------------------------------------*/
 uint32_t iteration=0;
@@ -64,9 +82,12 @@ void* initialize()
 {
         const TickType_t xDelay_2_sec = 2;
 	int esp8266_init_error = 0;
+	uint32_t link;
 
-	fifo_init(&tcp_rcv_fifo);
-	fifo_init(&tcp_send_fifo);
+	for(link = 0; link < ESP8266_MAX_LINKS; link++)
+	{
+		esp8266_link_closed(link);
+	}
 
 	do
 	{
@@ -153,16 +174,15 @@ void* initialize()
 		}
 		DEBUG(TRACE, "ESP8266 enable multiple connections [OK]\r\n");
 
-		// sets the maximum connections allowed by server to one (must be called before server creation)
-		/*if(!esp8266_set_maximum_connections_to_one())
+		// sets the maximum connections allowed by server to ESP8266_MAX_LINKS (must be called before server creation)
+		if(!esp8266_set_maximum_connections())
 		{
-			DEBUG(TRACE, "ESP8266 set the maximum connections to one [failed]\r\n");
+			DEBUG(TRACE, "ESP8266 set the maximum connections [failed]\r\n");
 			vTaskDelay( xDelay_2_sec );
 			esp8266_init_error = 1;
 			continue;
 		}
-		DEBUG(TRACE, "ESP8266 set the maximum connections to one [OK]\r\n");
-	*/
+		DEBUG(TRACE, "ESP8266 set the maximum connections [OK]\r\n");
 
 	} while(esp8266_init_error);
 
@@ -222,90 +242,197 @@ uint32_t ext_listen( void* LSocket){
 }
 
 /*
- * parameter data must point to an array of IN_MAX_MESSAGE_SIZE bytes minimum !!!
- * returns the number of bytes actually read
+ * Looks at the links in turn, starting after the one served last,
+ * so that a busy client can't starve the others, and returns every
+ * complete frame found, up to max_frames.
+ * The frames point into the receive fifos: they stay valid until
+ * ext_release_frames is called, no data is received in between.
+ * returns the number of frames
  */
-uint32_t ext_receive(void* ClientSocket, char* data)
+uint32_t ext_receive_frames(void* ClientSocket, ext_frame_t *frames, uint32_t max_frames)
 {
 	/* Remove compiler warning about unused parameter. */
 	(void) ClientSocket;
 
-	uint32_t target_bytes_count_to_receive = 0;
+	uint32_t count = 0;
+	uint32_t i;
 
-	/*
-	 * check data parameter is not null
-	 */
-	if(data == NULL)
+	for(i = 0; i < ESP8266_MAX_LINKS && count < max_frames; i++)
 	{
-		DEBUG(CRITICAL, "[ext_receive] data parameter pointer is NULL.\r\n");
-		return target_bytes_count_to_receive;
+		rcv_link = (rcv_link + 1) % ESP8266_MAX_LINKS;
+		if(fifo_get_length(&links[rcv_link].rcv_fifo) > 0)
+		{
+			count += ext_receive_link(rcv_link, &frames[count], max_frames - count);
+		}
 	}
 
-	/*
-	 * check "ODSI" reception
-	 */
-	uint8_t peek_data_length = 4;
-	target_bytes_count_to_receive = fifo_peek(&tcp_rcv_fifo, data, peek_data_length);
-	data[4] = '\0';
+	return count;
+}
+
+/*
+ * Drops the frames returned by ext_receive_frames
+ * and the garbage skipped in front of them
+ */
+void ext_release_frames(void* ClientSocket)
+{
+	/* Remove compiler warning about unused parameter. */
+	(void) ClientSocket;
+
+	uint32_t link;
 
-	if( (target_bytes_count_to_receive == peek_data_length) && (strcmp(data, "ODSI") == 0) )
+	for(link = 0; link < ESP8266_MAX_LINKS; link++)
 	{
-		/*
-		 * peek "OSDI" + received size attribute (4 bytes) from fifo
-		 */
-		peek_data_length = 8;
-		target_bytes_count_to_receive = fifo_peek(&tcp_rcv_fifo, data, peek_data_length);
+		fifo_drop(&links[link].rcv_fifo, links[link].rcv_consumed);
+		links[link].rcv_consumed = 0;
+	}
+}
 
-		if(target_bytes_count_to_receive == peek_data_length)
+/*
+ * Splits the receive fifo of a link into frames:
+ * "ODSI" <size, 4 bytes> <size bytes>
+ * A frame may have been split over several tcp segments, the incomplete tail
+ * is left in the fifo for the next call. Bytes which do not start a frame are
+ * skipped up to the next magic.
+ * returns the number of frames
+ */
+static uint32_t ext_receive_link(uint32_t link, ext_frame_t *frames, uint32_t max_frames)
+{
+	fifo_t *tcp_rcv_fifo = &links[link].rcv_fifo;
+	const char *data = fifo_linearize(tcp_rcv_fifo);
+	uint32_t length = fifo_get_length(tcp_rcv_fifo);
+	uint32_t offset = links[link].rcv_consumed;
+	uint32_t count = 0;
+	uint32_t size;
+
+	while(count < max_frames && length - offset >= ODSI_FRAME_HEADER_SIZE)
+	{
+		if(memcmp(&data[offset], ODSI_FRAME_MAGIC, 4) != 0)
 		{
-			target_bytes_count_to_receive = *((uint32_t*)(data+4));
-			uint32_t fifo_new_length = fifo_get_length(&tcp_rcv_fifo) - peek_data_length;
+			// resync on the next magic
+			offset += 1 + odsi_find_magic(&data[offset + 1], length - offset - 1);
+			continue;
+		}
 
-			if( (target_bytes_count_to_receive > 0) && (target_bytes_count_to_receive <= fifo_new_length) )
-			{
-				if(target_bytes_count_to_receive > IN_MAX_MESSAGE_SIZE)
-				{
-					target_bytes_count_to_receive = IN_MAX_MESSAGE_SIZE;
-					DEBUG(CRITICAL, "[ext_receive] Received size attribute is bigger than IN_MAX_MESSAGE_SIZE. extra data ignored\r\n");
-				}
-
-				fifo_pull(&tcp_rcv_fifo, data, peek_data_length);
-				fifo_pull(&tcp_rcv_fifo, data, target_bytes_count_to_receive);
-			}
-			else
-			{
-				target_bytes_count_to_receive = 0;
-			}
+		memcpy(&size, &data[offset + 4], sizeof(size));
+
+		// a frame the fifo can't hold would never complete
+		if(size == 0 || size > fifo_get_size(tcp_rcv_fifo) - ODSI_FRAME_HEADER_SIZE)
+		{
+			DEBUG(CRITICAL, "[ext_receive] bad frame size %d on link %d\r\n", size, link);
+			offset++;
+			continue;
 		}
-		else
+
+		if(length - offset - ODSI_FRAME_HEADER_SIZE < size)
 		{
-			target_bytes_count_to_receive = 0;
+			// wait for the rest of the frame
+			break;
 		}
+
+		frames[count].link = link;
+		frames[count].data = &data[offset + ODSI_FRAME_HEADER_SIZE];
+		frames[count].size = size;
+		count++;
+
+		offset += ODSI_FRAME_HEADER_SIZE + size;
 	}
-	else
+
+	links[link].rcv_consumed = offset;
+
+	return count;
+}
+
+/*
+ * Looks for the first byte of the magic four bytes at a time
+ *
+ * returns its offset, or size if it isn't there
+ */
+static uint32_t odsi_find_magic(const char *data, uint32_t size)
+{
+	const uint32_t ones = 0x01010101;
+	const uint32_t pattern = ones * (uint8_t) ODSI_FRAME_MAGIC[0];
+	uint32_t offset = 0;
+	uint32_t word;
+
+	for(; offset + sizeof(word) <= size; offset += sizeof(word))
+	{
+		memcpy(&word, &data[offset], sizeof(word));
+		word ^= pattern;
+		// some byte of word is zero
+		if((word - ones) & ~word & (ones << 7))
+		{
+			break;
+		}
+	}
+
+	for(; offset < size; offset++)
 	{
-		// pull a character
-		fifo_pull(&tcp_rcv_fifo, data, 1);
-		target_bytes_count_to_receive = 0;
+		if(data[offset] == ODSI_FRAME_MAGIC[0])
+		{
+			break;
+		}
 	}
 
-	return target_bytes_count_to_receive;
+	return offset;
 }
 
 /*
  * TODO this function needs to return something like (success or failure)
  * TODO use mutex to support multiple task access
  *
+ * queues the response on the link its request came from,
+ * it is dropped if that client is gone
  */
-void ext_send(void* ClientSocket, char* outData, uint32_t size){
+void ext_send(void* ClientSocket, char* outData, uint32_t size, uint32_t link){
 	/* Remove compiler warning about unused parameter. */
 	(void) ClientSocket;
 
+	if(link >= ESP8266_MAX_LINKS || !links[link].connected)
+	{
+		DEBUG(TRACE, "[ext_send] link %d is not connected, response dropped\r\n", link);
+		return;
+	}
+
 	//char magic_data[4] = { 'O', 'D', 'S', 'I'};
 
-	//fifo_push(&tcp_send_fifo, magic_data, sizeof(magic_data));
-	fifo_push(&tcp_send_fifo, (char*)&size, sizeof(size));
-	fifo_push(&tcp_send_fifo, outData, size);
+	//fifo_push(&links[link].send_fifo, magic_data, sizeof(magic_data));
+	fifo_push(&links[link].send_fifo, (char*)&size, sizeof(size));
+	fifo_push(&links[link].send_fifo, outData, size);
+}
+
+void esp8266_link_connected(uint32_t link)
+{
+	if(link < ESP8266_MAX_LINKS)
+	{
+		links[link].connected = 1;
+	}
+}
+
+/*
+ * forgets whatever the client left behind, the link number will be reused
+ */
+void esp8266_link_closed(uint32_t link)
+{
+	if(link < ESP8266_MAX_LINKS)
+	{
+		links[link].connected = 0;
+		links[link].rcv_consumed = 0;
+		fifo_init(&links[link].rcv_fifo);
+		fifo_init(&links[link].send_fifo);
+	}
+}
+
+uint32_t esp8266_links_connected()
+{
+	uint32_t count = 0;
+	uint32_t link;
+
+	for(link = 0; link < ESP8266_MAX_LINKS; link++)
+	{
+		count += links[link].connected;
+	}
+
+	return count;
 }
 
 void mycloseSocket(void* Socket){
@@ -652,9 +779,9 @@ static int esp8266_enable_multiple_connections()
 }
 
 /*
- * returns 1 if succeeded to sets the maximum connections allowed by server to one
+ * returns 1 if succeeded to sets the maximum connections allowed by server to ESP8266_MAX_LINKS
  */
-static int esp8266_set_maximum_connections_to_one()
+static int esp8266_set_maximum_connections()
 {
 	int ret = 0;
 	char rcv_buf[2];
@@ -663,8 +790,8 @@ static int esp8266_set_maximum_connections_to_one()
 	// mettre le buffer � zero
 	memset(rcv_buf, 0, sizeof(rcv_buf));
 
-	// sets the maximum connections allowed by server to one
-	vGalileo_UART0_write((const char *)ESP8266_AT_SET_MAX_CONN_TO_ONE, strlen((const char *)ESP8266_AT_SET_MAX_CONN_TO_ONE));
+	// sets the maximum connections allowed by server to ESP8266_MAX_LINKS
+	vGalileo_UART0_write((const char *)ESP8266_AT_SET_MAX_CONN, strlen((const char *)ESP8266_AT_SET_MAX_CONN));
 	vTaskDelay_ms( xDelay_1_ms );
 
 	// should receive OK
@@ -854,7 +981,7 @@ int esp8266_check_IPD_reception(char *rcv_buf)
  * Get the link number from the tcp header (after "+IPD")
  * This functions consumes the comma ',' after the link number
  *
- * @returns the link number in the range of [0-4] or '\0' if an error occurred
+ * @returns the link number in the range of [0-(ESP8266_MAX_LINKS-1)] or '\0' if an error occurred
  */
 static char esp8266_get_link_number()
 {
@@ -868,8 +995,8 @@ static char esp8266_get_link_number()
 
 	if(read_size > 0)
 	{
-		// test if the second character is a comma ',' and the first character is >= '0' and <= '4'
-		if((rcv_buf[1] == ',') && (rcv_buf[0] >= '0') && (rcv_buf[0] <= '4') )
+		// test if the second character is a comma ',' and the first character is a valid link
+		if((rcv_buf[1] == ',') && (rcv_buf[0] >= '0') && (rcv_buf[0] < '0' + ESP8266_MAX_LINKS) )
 		{
 			DEBUG(TRACE, "link number, reception [OK]\r\n");
 			link_number = rcv_buf[0];
@@ -939,14 +1066,11 @@ static int esp8266_get_tcp_segment_payload_length()
 /*
  * Attempts to read TCP header
  *
- * @param header point to an array of 12 bytes minimum in order to hold the header
+ * @param (out) link the link the segment was received on
  * @return the payload size of tcp segment
  */
-unsigned int esp8266_get_tcp_header(char *header)
+unsigned int esp8266_get_tcp_header(uint32_t *link)
 {
-	/* Remove compiler warning about unused parameter. */
-	(void)header;
-
 	unsigned int payload_size = 0;
 
 	// get link number
@@ -957,77 +1081,67 @@ unsigned int esp8266_get_tcp_header(char *header)
 		return payload_size;
 	}
 	DEBUG(TRACE, "link number is : %c\r\n", link_number);
+	*link = link_number - '0';
 
 	// get tcp segment payload length
 	payload_size = esp8266_get_tcp_segment_payload_length();
 
-	printf("tcp segment payload length : %d\r\n", 10);
-	printf("tcp segment payload length : %d\r\n", payload_size);
-
 	return payload_size;
 }
 
-// TODO manage fifo overflow case
 /*
  * attempts to get tcp payload of the received tcp segment from the ESP8266 module
+ * and pushes it in the receive fifo of the link. The payload is read in place
+ * into the fifo. What doesn't fit is dropped, the frame layer resyncs on the
+ * next magic.
  *
- * @param (out) payload point to an array in order to hold the payload
+ * @param (in) link the link the segment was received on
  * @param (in) payload size
  * @return payload size
  */
-int esp8266_get_tcp_payload(unsigned int payload_size)
+int esp8266_get_tcp_payload(uint32_t link, unsigned int payload_size)
 {
 	unsigned int remaining_bytes = payload_size;
-	uint32_t rcv_buf_size = 4096;
-	char *rcv_buf = pvPortMalloc(rcv_buf_size);
-
-
-	if(rcv_buf == NULL)
-	{
-		printf("AllocPage failed !!!\r\n");
-		return 0;
-	}
-
-	//char rcv_buf[ESP8266_RCV_PAYLOAD_MAX_SIZE];
-
-	const TickType_t xDelay_1_ms = 1 ;
-
-	printf("hello from get_tcp_payload 0\r\n");
-
-	if(remaining_bytes > rcv_buf_size)
-	{
-		remaining_bytes = 0;
-		DEBUG(CRITICAL, "tcp received segment payload is bigger than ESP8266_RCV_PAYLOAD_MAX_SIZE\r\n");
-	}
-
-	printf("hello from get_tcp_payload 1\r\n");
+	fifo_t *tcp_rcv_fifo = &links[link].rcv_fifo;
+	char discard[64];
+	char *span;
+	uint32_t span_size;
+	unsigned long read_size;
 
 	while(remaining_bytes > 0)
 	{
-		printf("hello from get_tcp_payload 2\r\n");
-		int read_size = vGalileo_UART0_read(rcv_buf, remaining_bytes);
-		printf("hello from get_tcp_payload 3\r\n");
-		if(read_size > 0)
+		span_size = fifo_write_span(tcp_rcv_fifo, &span);
+		if(span_size == 0)
 		{
-			// push the received bytes in the receive fifo
-			printf("push the received bytes in the receive fifo\r\n");
-
-			while(!fifo_push(&tcp_rcv_fifo, rcv_buf, read_size))
-			{
-				DEBUG(CRITICAL, "tcp rcv FIFO overflow\r\n");
-				vTaskDelay_ms(xDelay_1_ms);
-			}
+			span = discard;
+			span_size = sizeof(discard);
+		}
+		if(span_size > remaining_bytes)
+		{
+			span_size = remaining_bytes;
+		}
 
-			// update remaining bytes to get
-			remaining_bytes -= read_size;
+		read_size = vGalileo_UART0_read(span, span_size);
+		if(read_size == 0)
+		{
+			DEBUG(CRITICAL, "tcp segment payload truncated\r\n");
+			break;
 		}
-	}
 
-	vPortFree(rcv_buf);
+		if(span != discard)
+		{
+			fifo_commit(tcp_rcv_fifo, read_size);
+		}
+		else
+		{
+			DEBUG(CRITICAL, "tcp rcv FIFO overflow\r\n");
+		}
 
-	printf("just before return from get_tcp_payload\r\n");
+		// update remaining bytes to get
+		remaining_bytes -= read_size;
+	}
 
-	return payload_size;
+	return payload_size - remaining_bytes;
 }
 
 /*
@@ -1056,16 +1170,36 @@ static int esp8266_send_tcp_payload(char *payload, unsigned int payload_size)
 	return ret;
 }
 
+/*
+ * Picks the next link with something to send, round robin,
+ * and sends the tcp header of its next segment
+ *
+ * returns the segment size, 0 if nothing was sent
+ */
 uint32_t try_to_send_tcp_header()
 {
-	uint32_t size = fifo_get_length(&tcp_send_fifo);
+	uint32_t size = 0;
+	uint32_t link = send_link;
+	uint32_t i;
+
+	for(i = 0; i < ESP8266_MAX_LINKS && size == 0; i++)
+	{
+		link = (link + 1) % ESP8266_MAX_LINKS;
+		size = fifo_get_length(&links[link].send_fifo);
+	}
+
+	if(size == 0)
+	{
+		return size;
+	}
+	send_link = link;
 
 	if(size > ESP8266_SEND_BUFFER_MAX_SIZE)
 	{
 		size = ESP8266_SEND_BUFFER_MAX_SIZE;
 	}
 
-	if(!esp8266_send_tcp_header(size))
+	if(!esp8266_send_tcp_header(send_link, size))
 	{
 		size = 0;
 	}
@@ -1078,7 +1212,7 @@ void send_tcp_payload(uint32_t size)
 	char data[ESP8266_SEND_BUFFER_MAX_SIZE];
 	uint32_t available_size = 0;
 
-	available_size = fifo_peek(&tcp_send_fifo, data, size);
+	available_size = fifo_peek(&links[send_link].send_fifo, data, size);
 
 	if(available_size != size)
 	{
@@ -1093,7 +1227,7 @@ void remove_tcp_payload_from_send_fifo(uint32_t size)
 	char data[ESP8266_SEND_BUFFER_MAX_SIZE];
 	uint32_t available_size = 0;
 
-	available_size = fifo_pull(&tcp_send_fifo, data, size);
+	available_size = fifo_pull(&links[send_link].send_fifo, data, size);
 
 	if(available_size != size)
 	{
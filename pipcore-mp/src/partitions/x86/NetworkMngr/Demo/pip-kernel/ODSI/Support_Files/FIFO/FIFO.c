@@ -11,6 +11,7 @@
 
 // static functions prototypes
 static inline uint32_t fifo_get_write_index(fifo_t *fifo);
+static void fifo_reverse(char *data, uint32_t size);
 
 /*
  * init fifo struct elements
@@ -57,8 +58,6 @@ int fifo_push(fifo_t *fifo, char *data, uint32_t size_to_push)
 
 	ret = 1;
 
-	printf("just before return from fifo_push\r\n");
-
 	return ret;
 }
 
@@ -119,6 +118,69 @@ uint32_t fifo_peek(fifo_t *fifo, char *data, uint32_t size_to_peek)
 	return size_to_peek;
 }
 
+/*
+ * discard data without copying it
+ */
+void fifo_drop(fifo_t *fifo, uint32_t size_to_drop)
+{
+	if(size_to_drop > fifo->length)
+	{
+		size_to_drop = fifo->length;
+	}
+
+	fifo->index += size_to_drop;
+	if(fifo->index > (sizeof(fifo->buffer) - 1) )
+	{
+		fifo->index -= sizeof(fifo->buffer);
+	}
+	fifo->length -= size_to_drop;
+}
+
+/*
+ * Makes the whole content contiguous, rotating the buffer in place if it
+ * wraps around the end, so that it can be read through a single pointer.
+ *
+ * returns a pointer to the first byte, valid until the next push
+ */
+char *fifo_linearize(fifo_t *fifo)
+{
+	if(fifo->index + fifo->length > sizeof(fifo->buffer))
+	{
+		// rotate left by index
+		fifo_reverse(fifo->buffer, fifo->index);
+		fifo_reverse(&(fifo->buffer[fifo->index]), sizeof(fifo->buffer) - fifo->index);
+		fifo_reverse(fifo->buffer, sizeof(fifo->buffer));
+		fifo->index = 0;
+	}
+
+	return &(fifo->buffer[fifo->index]);
+}
+
+/*
+ * Points span at the contiguous free space after the data, so that it can be
+ * filled in place. fifo_commit makes the written bytes part of the fifo.
+ *
+ * returns the size of the span
+ */
+uint32_t fifo_write_span(fifo_t *fifo, char **span)
+{
+	uint32_t write_index = fifo_get_write_index(fifo);
+	uint32_t size = sizeof(fifo->buffer) - fifo->length;
+
+	if(size > sizeof(fifo->buffer) - write_index)
+	{
+		size = sizeof(fifo->buffer) - write_index;
+	}
+	*span = &(fifo->buffer[write_index]);
+
+	return size;
+}
+
+void fifo_commit(fifo_t *fifo, uint32_t size_written)
+{
+	fifo->length += size_written;
+}
+
 inline uint32_t fifo_get_size(fifo_t *fifo)
 {
 	return sizeof(fifo->buffer);
@@ -140,3 +202,16 @@ static inline uint32_t fifo_get_write_index(fifo_t *fifo)
 
 	return write_index;
 }
+
+static void fifo_reverse(char *data, uint32_t size)
+{
+	char tmp;
+	uint32_t i;
+
+	for(i = 0; i < size / 2; i++)
+	{
+		tmp = data[i];
+		data[i] = data[size - 1 - i];
+		data[size - 1 - i] = tmp;
+	}
+}
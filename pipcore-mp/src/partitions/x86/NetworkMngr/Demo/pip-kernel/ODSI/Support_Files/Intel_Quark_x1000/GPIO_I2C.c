@@ -32,6 +32,7 @@
  * Any required includes
  *------------------------------------------------------------------------
  */
+#include <pip/api.h>
 #include "GPIO_I2C.h"
 
 /*-----------------------------------------------------------------------
@@ -61,16 +62,25 @@ static uint32_t bGalileoGPIOInitialized = FALSE;
  */
  static uint32_t pciIOread32(uint32_t addr)
  {
-	  outl(IO_PCI_ADDRESS_PORT, addr);
-	  uint32_t data = inl(IO_PCI_DATA_PORT);
- 	  return data;
+	  /* Address and data cycles in a single kernel entry */
+	  Pip_IoOp io[2] = {
+		  { PIP_IO_OUTL, IO_PCI_ADDRESS_PORT, addr, 0 },
+		  { PIP_IO_INL, IO_PCI_DATA_PORT, 0, 0 },
+	  };
+	  /* A cut-short batch reads as all ones, like a PCI master abort */
+	  if(Pip_IoBatch(io, 2) != 2)
+		  return 0xFFFFFFFF;
+ 	  return io[1].value;
  }
  /*-----------------------------------------------------------*/
 
  static void pciIOwrite32(uint32_t addr, uint32_t IO_data)
  {
-	 outl(IO_PCI_ADDRESS_PORT, addr);
-	 outl(IO_PCI_DATA_PORT, IO_data );
+	 Pip_IoOp io[2] = {
+		 { PIP_IO_OUTL, IO_PCI_ADDRESS_PORT, addr, 0 },
+		 { PIP_IO_OUTL, IO_PCI_DATA_PORT, IO_data, 0 },
+	 };
+	 Pip_IoBatch(io, 2);
  }
  /*-----------------------------------------------------------*/
 
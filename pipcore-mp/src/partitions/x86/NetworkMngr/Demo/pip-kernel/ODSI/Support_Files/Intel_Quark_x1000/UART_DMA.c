@@ -37,25 +37,28 @@ void set_v_dma_buffer(uint32_t v_dma_buffer_addr)
 }
 
 /*
- * Use DMA
- * returns 1 if their is data available to be read
+ * Bytes the DMA wrote since buffer_index, from a single read of its
+ * destination pointer
  */
-int vGalileo_UART0_is_data_available()
+static uint32_t uart0_dma_pending()
 {
-	volatile uint32_t dest_addr = 0;
-	int ret = 0;
-
-	dest_addr = mem_read(DMA_UART_0_MMIO_Base, R_DMA_DAR0, 4);
-	printf("Dest_addr\t\t\t\t\t%x\r\n", dest_addr);
-	printf("DMA_buffer\t\t\t\t\t%x\r\n", dma_buffer);
-	printf("Buffer_index\t\t\t\t\t%x\r\n", buffer_index);
-	// checks if the dest_addr changed
-	if((dest_addr - (uint32_t)dma_buffer) != buffer_index)
+	uint32_t head = mem_read(DMA_UART_0_MMIO_Base, R_DMA_DAR0, 4) - (uint32_t)dma_buffer;
+
+	// the destination reloads at the end of the block
+	if(head >= BUFFER_SIZE)
 	{
-		ret = 1;
+		head = 0;
 	}
+	return (head + BUFFER_SIZE - buffer_index) % BUFFER_SIZE;
+}
 
-	return ret;
+/*
+ * Use DMA
+ * returns 1 if their is data available to be read
+ */
+int vGalileo_UART0_is_data_available()
+{
+	return uart0_dma_pending() != 0;
 }
 
 /*
@@ -63,43 +66,78 @@ int vGalileo_UART0_is_data_available()
  */
 void vGalileo_UART0_flush_DMA_rcv_buffer()
 {
-	volatile uint32_t dest_addr = 0;
-
-	dest_addr = mem_read(DMA_UART_0_MMIO_Base, R_DMA_DAR0, 4);
-
-	// checks if the dest_addr changed
-	if((dest_addr - (uint32_t)dma_buffer) != buffer_index)
-	{
-		buffer_index = dest_addr - (uint32_t)dma_buffer;
-	}
+	buffer_index = (buffer_index + uart0_dma_pending()) % BUFFER_SIZE;
 }
 
-char uart0_dma_buffer_read_8()
+/*
+ * Copies everything received since the last read, up to max bytes: one span,
+ * or two when the DMA wrapped around the end of the buffer.
+ * Waits up to UART0_DMA_READ_TIMEOUT ms for the first byte.
+ * returns the number of read bytes, 0 on timeout
+ */
+unsigned long uart0_dma_read_available(char *buf, unsigned long max)
 {
-	volatile uint32_t dest_addr = 0;
-	char data_8 = 0;
+	uint32_t pending, span;
+	uint32_t waited = 0;
 
-	/* Block for 1ms. */
-	const TickType_t xDelay = 100;
+	while((pending = uart0_dma_pending()) == 0)
+	{
+		if(waited++ >= UART0_DMA_READ_TIMEOUT)
+		{
+			return 0;
+		}
+		vTaskDelay_ms(1);
+	}
 
-	dest_addr = mem_read(DMA_UART_0_MMIO_Base, R_DMA_DAR0, 4);
+	if(pending > max)
+	{
+		pending = max;
+	}
 
-	// checks if the dest_addr changed
-	while((dest_addr - (uint32_t)dma_buffer) == buffer_index)
+	span = BUFFER_SIZE - buffer_index;
+	if(span > pending)
 	{
-		dest_addr = mem_read(DMA_UART_0_MMIO_Base, R_DMA_DAR0, 4);
+		span = pending;
 	}
+	memcpy(buf, &vDma_buffer[buffer_index], span);
+	memcpy(buf + span, vDma_buffer, pending - span);
 
-	// there is something to read
-	vTaskDelay_ms( xDelay );
-	data_8 = vDma_buffer[buffer_index];
-	buffer_index++;
-	if(buffer_index >= BUFFER_SIZE)
+	buffer_index = (buffer_index + pending) % BUFFER_SIZE;
+
+	return pending;
+}
+
+/*
+ * Points span at the received bytes without copying them, stopping at the end
+ * of the buffer when the DMA wrapped around. Does not wait.
+ * returns the length of the span, 0 if nothing was received
+ */
+unsigned long uart0_dma_peek(const char **span)
+{
+	uint32_t pending = uart0_dma_pending();
+
+	if(pending > BUFFER_SIZE - buffer_index)
 	{
-		buffer_index = 0;
+		pending = BUFFER_SIZE - buffer_index;
 	}
+	*span = (const char *)&vDma_buffer[buffer_index];
+
+	return pending;
+}
+
+/*
+ * Releases the first size bytes returned by uart0_dma_peek
+ */
+void uart0_dma_consume(unsigned long size)
+{
+	buffer_index = (buffer_index + size) % BUFFER_SIZE;
+}
+
+char uart0_dma_buffer_read_8()
+{
+	char data_8 = 0;
 
-	printf("%x\t%c\r\n", data_8, data_8);
+	uart0_dma_read_available(&data_8, 1);
 
 	return data_8;
 }
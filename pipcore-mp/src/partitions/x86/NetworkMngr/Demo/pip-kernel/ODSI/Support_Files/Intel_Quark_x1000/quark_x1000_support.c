@@ -557,9 +557,14 @@ void show_kernel_parameters( unsigned long magic, unsigned long addr )
 	{*/
 		if (bGalileo_client_SerialPortInitialized)
 		{
-			for(i = 0; i < size; i++)
+			while(i < size)
 			{
-				buf[i] = uart0_dma_buffer_read_8();
+				unsigned long read = uart0_dma_read_available(&buf[i], size - i);
+				if(read == 0)
+				{
+					break;
+				}
+				i += read;
 			}
 		}
 		/*xSemaphoreGiveRecursive(semUART0Gate);
@@ -586,8 +591,9 @@ void show_kernel_parameters( unsigned long magic, unsigned long addr )
 		{
 			for(i = 0; i < max_size; i++)
 			{
-				char c = uart0_dma_buffer_read_8();
-				if(c == '\n' || c == '\r')
+				char c;
+				// the end of the line must stay in the buffer, read byte-wise
+				if(uart0_dma_read_available(&c, 1) == 0 || c == '\n' || c == '\r')
 				{
 					break;
 				}
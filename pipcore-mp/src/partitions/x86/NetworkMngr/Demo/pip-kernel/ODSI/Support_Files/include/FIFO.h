@@ -25,6 +25,10 @@ void fifo_init(fifo_t *fifo);
 int fifo_push(fifo_t *fifo, char *data, uint32_t size_to_push);
 uint32_t fifo_pull(fifo_t *fifo, char *data, uint32_t size_to_pull);
 uint32_t fifo_peek(fifo_t *fifo, char *data, uint32_t size_to_pull);
+void fifo_drop(fifo_t *fifo, uint32_t size_to_drop);
+char *fifo_linearize(fifo_t *fifo);
+uint32_t fifo_write_span(fifo_t *fifo, char **span);
+void fifo_commit(fifo_t *fifo, uint32_t size_written);
 uint32_t fifo_get_size(fifo_t *fifo);
 uint32_t fifo_get_length(fifo_t *fifo);
 
@@ -60,4 +60,10 @@ void vGalileo_UART0_flush_DMA_rcv_buffer();
 void set_dma_buffer(uint32_t dma_buffer_addr);
 void set_v_dma_buffer(uint32_t v_dma_buffer_addr);
 
+// ms uart0_dma_read_available waits for a first byte
+#define UART0_DMA_READ_TIMEOUT			1000
+
+unsigned long uart0_dma_read_available(char *buf, unsigned long max);
+unsigned long uart0_dma_peek(const char **span);
+void uart0_dma_consume(unsigned long size);
 char uart0_dma_buffer_read_8();
@@ -7,44 +7,115 @@
 
 
 #include <stddef.h>
+#include <stdint.h>
 #include "mystdlib.h"
 
 /*-----------------------------------------------------------*/
 
+/* Below this size setting up a string instruction costs more than it saves */
+#define SMALL_COPY_SIZE		16
+
+/* Word accesses may alias any object, unaligned ones are fine on IA-32 */
+typedef uint32_t __attribute__((may_alias)) word_t;
+
 void *mymemcpy( void *pvDest, const void *pvSource, size_t xBytes )
 {
-/* The compiler used during development seems to err unless these volatiles are
-included at -O3 optimisation.  */
-volatile unsigned char *pcDest = ( volatile unsigned char * ) pvDest, *pcSource = ( volatile unsigned char * ) pvSource;
-size_t x;
-
-	/* Extremely crude standard library implementations in lieu of having a C
-	library. */
-	if( pvDest != pvSource )
+unsigned char *pcDest = ( unsigned char * ) pvDest;
+const unsigned char *pcSource = ( const unsigned char * ) pvSource;
+size_t xWords;
+
+	if( pvDest == pvSource )
+	{
+		return pvDest;
+	}
+
+	if( xBytes < SMALL_COPY_SIZE )
 	{
-		for( x = 0; x < xBytes; x++ )
+		while( xBytes-- )
 		{
-			pcDest[ x ] = pcSource[ x ];
+			*pcDest++ = *pcSource++;
 		}
+		return pvDest;
 	}
 
+	/* Align the destination, then move whole words and the remaining bytes */
+	while( ( ( size_t ) pcDest & ( sizeof( word_t ) - 1 ) ) != 0 )
+	{
+		*pcDest++ = *pcSource++;
+		xBytes--;
+	}
+
+	xWords = xBytes / sizeof( word_t );
+	xBytes &= sizeof( word_t ) - 1;
+
+#if defined( __i386__ )
+	__asm__ volatile( "cld\n\t"
+	                  "rep movsl\n\t"
+	                  "mov %3, %%ecx\n\t"
+	                  "rep movsb"
+	                  : "+D" ( pcDest ), "+S" ( pcSource ), "+c" ( xWords )
+	                  : "r" ( xBytes )
+	                  : "memory" );
+#else
+	while( xWords-- )
+	{
+		*( word_t * ) pcDest = *( const word_t * ) pcSource;
+		pcDest += sizeof( word_t );
+		pcSource += sizeof( word_t );
+	}
+	while( xBytes-- )
+	{
+		*pcDest++ = *pcSource++;
+	}
+#endif
+
 	return pvDest;
 }
 /*-----------------------------------------------------------*/
 
 void *mymemset( void *pvDest, int iValue, size_t xBytes )
 {
-/* The compiler used during development seems to err unless these volatiles are
-included at -O3 optimisation.  */
-volatile unsigned char * volatile pcDest = ( volatile unsigned char * volatile ) pvDest;
-volatile size_t x;
-
-	/* Extremely crude standard library implementations in lieu of having a C
-	library. */
-	for( x = 0; x < xBytes; x++ )
+unsigned char *pcDest = ( unsigned char * ) pvDest;
+word_t xPattern = ( unsigned char ) iValue * 0x01010101UL;
+size_t xWords;
+
+	if( xBytes < SMALL_COPY_SIZE )
+	{
+		while( xBytes-- )
+		{
+			*pcDest++ = ( unsigned char ) iValue;
+		}
+		return pvDest;
+	}
+
+	while( ( ( size_t ) pcDest & ( sizeof( word_t ) - 1 ) ) != 0 )
+	{
+		*pcDest++ = ( unsigned char ) iValue;
+		xBytes--;
+	}
+
+	xWords = xBytes / sizeof( word_t );
+	xBytes &= sizeof( word_t ) - 1;
+
+#if defined( __i386__ )
+	__asm__ volatile( "cld\n\t"
+	                  "rep stosl\n\t"
+	                  "mov %3, %%ecx\n\t"
+	                  "rep stosb"
+	                  : "+D" ( pcDest ), "+c" ( xWords )
+	                  : "a" ( xPattern ), "r" ( xBytes )
+	                  : "memory" );
+#else
+	while( xWords-- )
+	{
+		*( word_t * ) pcDest = xPattern;
+		pcDest += sizeof( word_t );
+	}
+	while( xBytes-- )
 	{
-		pcDest[ x ] = ( unsigned char ) iValue;
+		*pcDest++ = ( unsigned char ) iValue;
 	}
+#endif
 
 	return pvDest;
 }
@@ -52,20 +123,30 @@ volatile size_t x;
 
 int mymemcmp( const void *pvMem1, const void *pvMem2, unsigned long ulBytes )
 {
-const volatile unsigned char *pucMem1 = pvMem1, *pucMem2 = pvMem2;
-register unsigned long x;
-
-	/* Extremely crude standard library implementations in lieu of having a C
-	library. */
-    for( x = 0; x < ulBytes; x++ )
-    {
-        if( pucMem1[ x ] != pucMem2[ x ] )
-        {
-            break;
-        }
-    }
-
-    return ulBytes - x;
-}
+const unsigned char *pucMem1 = pvMem1, *pucMem2 = pvMem2;
+unsigned long x = 0;
 
+	/* Skip equal words, the mismatching byte is then found within the word.
+	As before the result is the number of bytes left from the first
+	difference, 0 when both areas are equal. */
+#if !defined( __i386__ )
+	if( ( ( ( size_t ) pucMem1 | ( size_t ) pucMem2 ) & ( sizeof( word_t ) - 1 ) ) == 0 )
+#endif
+	{
+		while( x + sizeof( word_t ) <= ulBytes &&
+		       *( const word_t * ) ( pucMem1 + x ) == *( const word_t * ) ( pucMem2 + x ) )
+		{
+			x += sizeof( word_t );
+		}
+	}
 
+	for( ; x < ulBytes; x++ )
+	{
+		if( pucMem1[ x ] != pucMem2[ x ] )
+		{
+			break;
+		}
+	}
+
+	return ulBytes - x;
+}
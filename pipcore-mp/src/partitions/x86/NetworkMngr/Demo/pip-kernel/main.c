@@ -168,6 +168,8 @@ void parse_bootinfo(pip_fpinfo* bootinfo)
 
 void main()
 {
+	/* Print through the console page the root drains, the UART is not ours */
+	Pip_Debug_SetConsole((Pip_Console*)0xFFFFD000);
 	pip_fpinfo * bootinfo = (pip_fpinfo*)0xFFFFC000;
 
 	//Get Bootinfo for the available memory
@@ -2054,6 +2054,7 @@ void *pvTaskIncrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
 
 
 uint32_t xTaskSwitchToProtectedTask();
+void vTaskConsoleDrain();
 
 
 #ifdef __cplusplus
@@ -1,17 +1,21 @@
 /* Standard includes. */
 #include <limits.h>
 #include <stdint.h>
+#include <string.h>
 /* Scheduler includes. */
 #include "FreeRTOS.h"
 #include "task.h"
 #include "timers.h"
 #include "queue.h"
+#include "semphr.h"
 #include "StackMacros.h"
 
 #include "pip/vidt.h"
 #include "pip/api.h"
+#include "pip/paging.h"
 #include "pip/compat.h"
 #include "partitionServices.h"
+#include "sharedChannel.h"
 
 
 extern void * pxCurrentTCB;
@@ -19,8 +23,6 @@ int checkAccess(){
   return 1;
 }
 
-extern enableSerialInChild();
-extern disableSerialInChild();
 uint32_t partitionCaller;
 void queueCreateService(uint32_t data2){
 
@@ -48,7 +50,6 @@ void queueCreateService(uint32_t data2){
     printf("Error in mapping service result\r\n");
   }
   printf("resuming\r\n");
-    enableSerialInChild();
   resume(partitionCaller, 1);
 }
 
@@ -87,7 +88,6 @@ void queueSendService(uint32_t data2){
     printf("Error in mapping service result\r\n");
   }
   printf("Resuming partition after sending\n",queue);
-  enableSerialInChild();
   resume(partitionCaller, 1);
 }
 void queueReceiveService(uint32_t data2){
@@ -124,7 +124,54 @@ void queueReceiveService(uint32_t data2){
     printf("Error in mapping service result\r\n");
   }
   printf("Resuming partition after receiving\n");
-  enableSerialInChild();
+  resume(partitionCaller, 1);
+}
+
+
+/* Moves up to count items in a single trap: one parameter page describes them all */
+void queueBatchService(uint32_t data2, uint32_t send){
+
+  printf("Starting queue batch services by %x\r\n",partitionCaller);
+  xQueueBatchParameters * dataCall;
+  dataCall = (xQueueBatchParameters*) Pip_RemoveVAddr(partitionCaller,data2);
+
+  QueueHandle_t queue = (QueueHandle_t)dataCall->queue;
+  uint32_t perPage = dataCall->itemSize ? 0x1000 / dataCall->itemSize : 0;
+  uint32_t pageCount = dataCall->pageCount;
+  uint8_t * dataPages[QUEUE_BATCH_MAX_PAGES];
+  uint32_t index;
+
+  dataCall->done = 0;
+  if(!perPage || pageCount > QUEUE_BATCH_MAX_PAGES || dataCall->count > perPage * pageCount){
+    printf("Invalid batch of %d items\r\n",dataCall->count);
+    goto out;
+  }
+
+  for(index=0;index<pageCount;index++)
+    dataPages[index] = (uint8_t*) Pip_RemoveVAddr(partitionCaller,dataCall->pages[index]);
+
+  for(index=0;index<dataCall->count;index++){
+    void * item = dataPages[index / perPage] + (index % perPage) * dataCall->itemSize;
+    if(send){
+      if(!xQueueSend(queue,item,dataCall->tickToWait))
+        break;
+    }
+    /* Only the first receive may block, then drain what is already there */
+    else if(!xQueueReceive(queue,item,index ? 0 : dataCall->tickToWait))
+      break;
+  }
+  dataCall->done = index;
+  printf("Batch moved %d items, message waiting %d\r\n",index,uxQueueMessagesWaiting(queue));
+
+  for(index=0;index<pageCount;index++){
+    if(Pip_MapPageWrapper(dataPages[index],partitionCaller,dataCall->pages[index])){
+      printf("Error in mapping service result\r\n");
+    }
+  }
+out:
+  if(Pip_MapPageWrapper(dataCall,partitionCaller,data2)){
+    printf("Error in mapping service result\r\n");
+  }
   resume(partitionCaller, 1);
 }
 
@@ -141,22 +188,19 @@ void sbrkService(uint32_t data2){
   uint32_t begin = *(dataCall+1);
   printf("Allocating memory %d pages at %x\r\n",size,begin);
 
-  int index;
-  uint32_t page;
-  for(index=0;index<size;index++){
-    page = allocPage();
-    if(Pip_MapPageWrapper(page,partitionCaller,begin+(index*0x1000))){
-      printf("Error in mapping sbrk call\r\n");
-      for(;;);
-    }
-
-    //printf("Allocating %x at %x\r\n",page,begin+(index*0x1000));
+  void * pages = allocPages(size);
+  if(!pages){
+    printf("Not enough pages for sbrk call\r\n");
+    for(;;);
+  }
+  if(Pip_MapPagesWrapper(pages,partitionCaller,begin,size)){
+    printf("Error in mapping sbrk call\r\n");
+    for(;;);
   }
   if(Pip_MapPageWrapper(dataCall,partitionCaller,data2)){
     printf("Error in mapping service result\r\n");
   }
   printf("return from sbrk service\r\n" );
-  enableSerialInChild();
   resume(partitionCaller, 1);
 
 }
@@ -192,15 +236,163 @@ void channelService(uint32_t data2){
   }
 
   printf("return from channelCom service service\r\n" );
-  enableSerialInChild();
   resume(partitionCaller, 1);
 
 }
 
 
 
+/* Root-private geometry: the copy in the ring header is only for the child */
+struct sharedChannel_s {
+  sharedChannelView_t view;
+  uint32_t pages;
+  uint32_t producer;
+  uint32_t consumer;
+  SemaphoreHandle_t itemsAvailable;
+  SemaphoreHandle_t spaceAvailable;
+};
+
+static struct sharedChannel_s sharedChannels[SHARED_CHANNEL_MAX];
+
+/* Each ring page is allocated and mapped on its own, the root reaches the
+ * slots through the page table of the view, so no contiguity is needed */
+static uint32_t mapRingPages(uint8_t ** pages, uint32_t count, uint32_t partition, uint32_t vaddr){
+  uint32_t index;
+  for(index=0;index<count;index++){
+    pages[index] = (uint8_t*) allocPage();
+    if(!pages[index] || Pip_MapPageWrapper((uint32_t)pages[index], partition, vaddr + index * PGSIZE)){
+      if(pages[index])
+        freePage(pages[index]);
+      while(index--){
+        Pip_RemoveVAddr(partition, vaddr + index * PGSIZE);
+        freePage(pages[index]);
+      }
+      memset(pages, 0, count * sizeof(uint8_t*));
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void channelRingOpenService(uint32_t data2){
+
+  printf("Starting channelRingOpen services by %x\r\n",partitionCaller);
+  xChannelOpenParameters * dataCall;
+  dataCall = (xChannelOpenParameters*) Pip_RemoveVAddr(partitionCaller,data2);
+  dataCall->returnCall = 0;
+
+  /* Bounding both sizes first also keeps sharedRingPages() from overflowing */
+  if(dataCall->id >= SHARED_CHANNEL_MAX || dataCall->role > SHARED_CHANNEL_CONSUMER
+     || !dataCall->itemSize || dataCall->itemSize > PGSIZE
+     || !dataCall->length || (dataCall->length & (dataCall->length - 1))
+     || dataCall->length > SHARED_CHANNEL_MAX_PAGES * PGSIZE / SHARED_CHANNEL_CACHE_LINE){
+    printf("Invalid channel request %d\r\n",dataCall->id);
+    goto out;
+  }
+  struct sharedChannel_s * channel = &sharedChannels[dataCall->id];
+  uint32_t pages = sharedRingPages(dataCall->itemSize, dataCall->length);
+
+  if(channel->pages && (channel->view.itemSize != dataCall->itemSize || channel->view.length != dataCall->length)){
+    printf("Channel %d already opened with another geometry\r\n",dataCall->id);
+    goto out;
+  }
+  uint8_t ** side = dataCall->role == SHARED_CHANNEL_PRODUCER ? channel->view.tx : channel->view.rx;
+  if(side[0] || pages > SHARED_CHANNEL_MAX_PAGES){
+    printf("Channel %d can't be opened\r\n",dataCall->id);
+    goto out;
+  }
+  if(!mapRingPages(side, pages, partitionCaller, dataCall->vaddr)){
+    printf("Error in mapping channel %d ring\r\n",dataCall->id);
+    goto out;
+  }
+  sharedRingInit((sharedRing_t*) side[0], dataCall->id, dataCall->itemSize, dataCall->length);
+
+  if(!channel->pages){
+    channel->view.itemSize = dataCall->itemSize;
+    channel->view.slotSize = sharedRingSlotSize(dataCall->itemSize);
+    channel->view.length = dataCall->length;
+    channel->pages = pages;
+    channel->itemsAvailable = xSemaphoreCreateBinary();
+    channel->spaceAvailable = xSemaphoreCreateBinary();
+  }
+  if(dataCall->role == SHARED_CHANNEL_PRODUCER)
+    channel->producer = partitionCaller;
+  else
+    channel->consumer = partitionCaller;
+  dataCall->returnCall = dataCall->vaddr;
+  printf("Channel %d ring mapped at %x\r\n",dataCall->id,dataCall->vaddr);
+
+out:
+  if(Pip_MapPageWrapper(dataCall,partitionCaller,data2)){
+    printf("Error in mapping service result\r\n");
+  }
+  resume(partitionCaller, 1);
+}
+
+/* Relays and wakes whichever side sleeps in the root on what just moved */
+static void sharedChannelWake(struct sharedChannel_s * channel){
+  if(!sharedChannelRelay(&channel->view))
+    return;
+  if(((sharedRing_t*) channel->view.rx[0])->consumerWaiting)
+    xSemaphoreGive(channel->itemsAvailable);
+  if(((sharedRing_t*) channel->view.tx[0])->producerWaiting)
+    xSemaphoreGive(channel->spaceAvailable);
+}
+
+void channelRingWaitService(uint32_t data2){
+
+  uint32_t id = data2 & 0xFF;
+  TickType_t tickToWait = (data2 >> 8) == SHARED_CHANNEL_MAX_WAIT ? portMAX_DELAY : (data2 >> 8);
+
+  if(id >= SHARED_CHANNEL_MAX){
+    printf("Invalid channel %d\r\n",id);
+    goto out;
+  }
+  struct sharedChannel_s * channel = &sharedChannels[id];
+  sharedRing_t * tx = (sharedRing_t*) channel->view.tx[0];
+  sharedRing_t * rx = (sharedRing_t*) channel->view.rx[0];
+  if(rx && partitionCaller == channel->consumer){
+    /* Producer rings the doorbell on every item from now on */
+    if(tx)
+      tx->consumerWaiting = 1;
+    __sync_synchronize();
+    sharedChannelWake(channel);
+    while(!sharedRingCount(rx)){
+      if(!xSemaphoreTake(channel->itemsAvailable, tickToWait) && tickToWait != portMAX_DELAY)
+        break;
+      sharedChannelWake(channel);
+    }
+    if(tx)
+      tx->consumerWaiting = 0;
+  }
+  else if(tx && partitionCaller == channel->producer){
+    sharedChannelWake(channel);
+    while(sharedRingCount(tx) >= channel->view.length){
+      if(!xSemaphoreTake(channel->spaceAvailable, tickToWait) && tickToWait != portMAX_DELAY)
+        break;
+      sharedChannelWake(channel);
+    }
+  }
+out:
+  resume(partitionCaller, 1);
+}
+
+/* Doorbell of both sides: the consumer pulling into its empty ring, the
+ * producer handing an item to a consumer asleep in the root */
+void channelRingNotifyService(uint32_t data2){
+
+  if(data2 >= SHARED_CHANNEL_MAX){
+    printf("Invalid channel %d\r\n",data2);
+    goto out;
+  }
+  sharedChannelWake(&sharedChannels[data2]);
+out:
+  resume(partitionCaller, 1);
+}
+
+
 INTERRUPT_HANDLER(serviceRoutineAsm,serviceRoutine)
-  disableSerialInChild();
+  vTaskConsoleDrain();
   printf("Starting service ");
   printf("Data1 %d, data2 %x\r\n",data1,data2);
   partitionCaller = caller;
@@ -222,6 +414,21 @@ INTERRUPT_HANDLER(serviceRoutineAsm,serviceRoutine)
     case channelCom:
         channelService(data2);
         break;
+    case channelRingOpen:
+        channelRingOpenService(data2);
+        break;
+    case channelRingWait:
+        channelRingWaitService(data2);
+        break;
+    case channelRingNotify:
+        channelRingNotifyService(data2);
+        break;
+    case queueSendBatch:
+        queueBatchService(data2, 1);
+        break;
+    case queueReceiveBatch:
+        queueBatchService(data2, 0);
+        break;
     default:
       __asm__ volatile("call vPortTimerHandler");
   }
@@ -0,0 +1,101 @@
+#ifndef _SHARED_CHANNEL_H
+#define _SHARED_CHANNEL_H
+#include <stdint.h>
+/*
+ * Shared-ring channels
+ *
+ * A channel carries fixed-size items from a producer partition to a consumer
+ * partition without stealing pages. Pip forbids mapping one page into two
+ * sibling partitions, so each endpoint owns a single-producer/single-consumer
+ * ring living in pages allocated by the root and shared vertically with it:
+ *
+ *   producer --(tx ring)--> root relay --(rx ring)--> consumer
+ *
+ * Pushing and popping are plain loads and stores on the ring. The root only
+ * copies when a doorbell (channelRingNotify, through Pip_Notify) is rung:
+ *  - by the consumer, when its ring is empty: it pulls everything the
+ *    producer pushed meanwhile, so a burst costs a single doorbell;
+ *  - by the producer, only while the consumer sleeps in the root.
+ * An endpoint otherwise only traps to sleep on an empty or full ring
+ * (channelRingWait), and is woken by the other side's doorbell.
+ *
+ * The ring header fills the first page, the slots are packed in the
+ * following ones and never straddle two pages: the root reaches them through
+ * its own page table, its pages need not be contiguous.
+ */
+
+#define SHARED_CHANNEL_MAGIC        0x52494E47 /* "RING" */
+#define SHARED_CHANNEL_CACHE_LINE   64
+#define SHARED_CHANNEL_PAGE         0x1000
+#define SHARED_CHANNEL_MAX          8
+#define SHARED_CHANNEL_MAX_PAGES    8
+
+#define SHARED_CHANNEL_PRODUCER     0
+#define SHARED_CHANNEL_CONSUMER     1
+
+/* Largest tick count that fits in a wait request, also used as portMAX_DELAY */
+#define SHARED_CHANNEL_MAX_WAIT     0xFFFFFF
+#define SHARED_CHANNEL_WAIT_ARG(id, ticks) (((ticks) << 8) | ((id) & 0xFF))
+
+struct sharedRing_s {
+  /* Written once by the root when the ring is created */
+  uint32_t magic;
+  uint32_t id;
+  uint32_t itemSize;
+  uint32_t slotSize;
+  uint32_t length;
+  uint8_t rfu0[SHARED_CHANNEL_CACHE_LINE - 5 * sizeof(uint32_t)];
+  /* Written by the producer side only */
+  volatile uint32_t head;
+  volatile uint32_t producerWaiting;
+  uint8_t rfu1[SHARED_CHANNEL_CACHE_LINE - 2 * sizeof(uint32_t)];
+  /* Written by the consumer side only */
+  volatile uint32_t tail;
+  volatile uint32_t consumerWaiting;
+  uint8_t rfu2[SHARED_CHANNEL_CACHE_LINE - 2 * sizeof(uint32_t)];
+} __attribute__((aligned(SHARED_CHANNEL_CACHE_LINE)));
+typedef struct sharedRing_s sharedRing_t;
+
+struct xChannelOpenParameters_s {
+  uint32_t id;
+  uint32_t role;
+  uint32_t itemSize;
+  uint32_t length;
+  uint32_t vaddr;
+  uint32_t returnCall;
+};
+typedef struct xChannelOpenParameters_s xChannelOpenParameters;
+
+/* Root side view of a channel. The geometry is the root's own copy: the ring
+ * pages are writable by the children, only head and tail are read from them */
+struct sharedChannelView_s {
+  uint32_t itemSize;
+  uint32_t slotSize;
+  uint32_t length;
+  uint8_t * tx[SHARED_CHANNEL_MAX_PAGES];
+  uint8_t * rx[SHARED_CHANNEL_MAX_PAGES];
+};
+typedef struct sharedChannelView_s sharedChannelView_t;
+
+/* Page and offset of a slot, after the header page */
+#define sharedRingSlotPage(index, slotSize, length) \
+  (1 + ((index) & ((length) - 1)) / (SHARED_CHANNEL_PAGE / (slotSize)))
+#define sharedRingSlotOffset(index, slotSize, length) \
+  ((((index) & ((length) - 1)) % (SHARED_CHANNEL_PAGE / (slotSize))) * (slotSize))
+
+uint32_t sharedRingSlotSize(uint32_t itemSize);
+uint32_t sharedRingPages(uint32_t itemSize, uint32_t length);
+void sharedRingInit(sharedRing_t * ring, uint32_t id, uint32_t itemSize, uint32_t length);
+uint32_t sharedRingPush(sharedRing_t * ring, const void * item);
+uint32_t sharedRingPop(sharedRing_t * ring, void * item);
+uint32_t sharedRingCount(sharedRing_t * ring);
+
+/* Root side */
+uint32_t sharedChannelRelay(sharedChannelView_t * channel);
+
+/* Partition side API */
+sharedRing_t * xProtectedChannelOpen(uint32_t id, uint32_t role, uint32_t itemSize, uint32_t length, uint32_t vaddr);
+uint32_t xProtectedChannelSend(sharedRing_t * channel, const void * item, uint32_t tickToWait);
+uint32_t xProtectedChannelReceive(sharedRing_t * channel, void * buffer, uint32_t tickToWait);
+
+#endif
@@ -89,6 +89,7 @@
 #include <pip/vidt.h>
 #include <pip/compat.h>
 #include <pip/fpinfo.h>
+#include <pip/debug.h>
 #include "cpuidh.h"
 /* Lint e961 and e750 are suppressed as a MISRA exception justified because ther
  MPU ports require MPU_WRAPPERS_INCLUDED_FROM_API_FILE to be defined for the
@@ -199,6 +200,7 @@ typedef struct tskTaskControlBlock {
 	vidt_t *vidt;
 	uint32_t typeOfTask;
 	uint32_t started;
+	Pip_Console *console; /*< Console page of a protected task, drained to the UART by the root. */
 
 
 } tskTCB;
@@ -564,11 +566,8 @@ static char *prvWriteNameToBuffer( char *pcBuffer, const char *pcTaskName );
 #endif
 
 
-#define EC_BASE 0xE0000000
-#define UART_MMIO_BSE 0x9000B000
-#define UART_PCI_BSE 0xE00A5000
-extern uint32_t * UART_MMIO_Base;
-extern uint32_t * UART_PCI_Base;
+/* Where a protected task finds its console page */
+#define CONSOLE_VADDR 0xFFFFD000
 static int next = 0;
 
 
@@ -605,12 +604,11 @@ uint32_t xTaskPartitionCreate(uint32_t base, uint32_t length,
 
 	printf("Mapping partition : \r\n");
 
-	for (offset = 0; offset < length; offset += 0x1000) {
-
-		if (mapPageWrapper((uint32_t*) (base + offset), partitionEntry,(uint32_t*) (load_addr + offset))) {
-			printf("Error during mapping %x into partition at \r\n",base+offset,load_addr+offset);
-			goto fail;
-		}
+	/* The image is contiguous on both sides, map it in a single range call */
+	offset = (length + 0x1000 - 1) & ~(0x1000 - 1);
+	if (mapRange((uint32_t) base, (uint32_t) partitionEntry, (uint32_t) load_addr, offset / 0x1000, PIP_MAP_RWX)) {
+		printf("Error during mapping %x into partition at %x\r\n",base,load_addr);
+		goto fail;
 	}
 
 
@@ -620,7 +618,6 @@ uint32_t xTaskPartitionCreate(uint32_t base, uint32_t length,
 
 
 	printf("Mapping additional memory for child\r\n");
-	uint32_t page;
 	pip_fpinfo * allocMem = (pip_fpinfo*) allocPage();
 
 	allocMem->magic = FPINFO_MAGIC;
@@ -628,34 +625,33 @@ uint32_t xTaskPartitionCreate(uint32_t base, uint32_t length,
 	allocMem->memend = ADDR_TO_MAP+(MAX_PAGE * 0x1000);
 
 
-	int index;
-
-
-	for(index = 0;index < MAX_PAGE;index++){
-		page = allocPage();
-		if (mapPageWrapper((uint32_t)page, (uint32_t)partitionEntry, (uint32_t*)( ADDR_TO_MAP+(index*0x1000))))
-			printf("Failed to map additional memory %x at %x\r\n",page,ADDR_TO_MAP+index*0x1000);
-
+	/* Take the whole range at once, the pages come chained through their first word */
+	void * pages = allocPages(MAX_PAGE);
+	if (!pages) {
+		printf("Not enough pages for additional memory\r\n");
+		goto fail;
 	}
 
-	printf("Index %d, MAX_PAGE %d\r\n",index,MAX_PAGE);
+	if (mapPagesWrapper(pages, (uint32_t)partitionEntry, ADDR_TO_MAP, MAX_PAGE))
+		printf("Failed to map additional memory at %x\r\n",ADDR_TO_MAP);
+
+	printf("MAX_PAGE %d\r\n",MAX_PAGE);
 	if (mapPageWrapper(allocMem, (uint32_t)partitionEntry, (uint32_t)0xFFFFC000 )) {
 		printf("Fail to map additional memory info\r\n");
 		goto fail;
 	}
 
 	printf("Mapping stack... ");
-	uint32_t stack_off = 0;
-	uint32_t stack_addr;
-	for(stack_off = 0; stack_off <= 0x10000; stack_off+=0x1000)
+	void * stack_pages = allocPages(0x10000 / 0x1000 + 1);
+	if (!stack_pages) {
+		printf("Not enough pages for the stack.\r\n");
+		goto fail;
+	}
+	if (mapPagesWrapper(stack_pages, (uint32_t)partitionEntry, 0xB10000, 0x10000 / 0x1000 + 1))
 	{
-	      stack_addr = (uint32_t)allocPage();
-		    if(mapPageWrapper((uint32_t)stack_addr, (uint32_t)partitionEntry, (uint32_t)0xB10000 + (stack_off)))
-		    {
-			    printf("Couldn't map stack.\r\n");
-			    goto fail;
-		    }
-	    }
+		printf("Couldn't map stack.\r\n");
+		goto fail;
+	}
 	printf("Done.\r\n");
 	printf("Mapping interrupt stack...\r\n");
   uint32_t isstack_addr = (uint32_t*)allocPage();
@@ -678,6 +674,15 @@ uint32_t xTaskPartitionCreate(uint32_t base, uint32_t length,
 			goto fail;
 		}
 
+	/* The task prints into its own page, the UART is never mapped into it */
+	pcTCB->console = (Pip_Console*) allocPage();
+	memset(pcTCB->console, 0, sizeof(Pip_Console));
+	pcTCB->console->magic = PIP_CONSOLE_MAGIC;
+	if (mapPageWrapper((uint32_t)pcTCB->console, (uint32_t)partitionEntry, (uint32_t)CONSOLE_VADDR)){
+		printf("Failed to map console\r\n");
+		goto fail;
+	}
+
 
 	pcTCB->pxTopOfStack = partitionEntry;
 
@@ -692,26 +697,32 @@ uint32_t xTaskPartitionCreate(uint32_t base, uint32_t length,
 
 }
 
-static int startPartition= 0;
-
-
-void enableSerialInChild(){
-
-		//printf("Mapping UART { 0x%x , 0x%x } in child 0x%x\r\n",UART_MMIO_Base,UART_PCI_Base,pxCurrentTCB->pxTopOfStack);
-		mapPageWrapper((uint32_t)EC_BASE,(uint32_t)pxCurrentTCB->pxTopOfStack,EC_BASE);
-		mapPageWrapper((uint32_t)UART_MMIO_BSE,(uint32_t)pxCurrentTCB->pxTopOfStack,UART_MMIO_BSE);
-		mapPageWrapper((uint32_t)UART_PCI_BSE,(uint32_t)pxCurrentTCB->pxTopOfStack,UART_PCI_BSE);
+/* Prints what the current protected task wrote in its console page, called
+ * whenever the root gets the CPU back from it */
+void vTaskConsoleDrain(){
+	Pip_Console *console = pxCurrentTCB ? pxCurrentTCB->console : NULL;
+	uint32_t head, tail, lost;
+
+	if(!console)
+		return;
+
+	/* Both indexes are writable by the task : print one ring at most */
+	head = console->head;
+	tail = console->tail;
+	if(head - tail > PIP_CONSOLE_SIZE)
+		tail = head - PIP_CONSOLE_SIZE;
+	while(tail != head){
+		Pip_Debug_Putc(console->data[tail & (PIP_CONSOLE_SIZE - 1)]);
+		tail++;
+	}
+	console->tail = tail;
+	lost = console->lost;
+	if(lost){
+		console->lost = 0;
+		printf("[%d console characters lost]\r\n", lost);
+	}
 }
 
-void disableSerialInChild(){
-	if(!startPartition)
-		return ;
-
-	Pip_RemoveVAddr((uint32_t)pxCurrentTCB->pxTopOfStack,EC_BASE);
-	Pip_RemoveVAddr((uint32_t)pxCurrentTCB->pxTopOfStack,UART_MMIO_BSE);
-	Pip_RemoveVAddr((uint32_t)pxCurrentTCB->pxTopOfStack,UART_PCI_BSE);
-	//printf("Getting back serial %x %x from %x\r\n",UART_MMIO_Base,UART_PCI_Base,pxCurrentTCB->pxTopOfStack);
-}
 uint32_t xTaskSwitchToProtectedTask(){
 
 	//printf("Handle if the task is protected\r\n");
@@ -722,16 +733,12 @@ uint32_t xTaskSwitchToProtectedTask(){
 			//printf("Timer Switching to protected task %x\r\n",(uint32_t)pxCurrentTCB->pxTopOfStack);
 			if(pxCurrentTCB->vidt->flags){
 				//printf("Resuming partition \r\n");
-				enableSerialInChild();
 				Pip_Resume((uint32_t*)pxCurrentTCB->pxTopOfStack,1);
 			}
-			enableSerialInChild();
 			Pip_Notify((uint32_t) pxCurrentTCB->pxTopOfStack, 33, 0, 0);
 		}else{
 			printf("Starting protected task %x\r\n",(uint32_t)pxCurrentTCB->pxTopOfStack);
 			pxCurrentTCB->started = 1;
-			enableSerialInChild();
-			startPartition = 1;
 			Pip_Notify((uint32_t) pxCurrentTCB->pxTopOfStack, 0, 0, 0);
 		}
 	}
@@ -778,6 +785,7 @@ BaseType_t xTaskGenericCreate(TaskFunction_t pxTaskCode,
 	if (pxNewTCB != NULL) {
 
         pxNewTCB->typeOfTask = type;
+        pxNewTCB->console = NULL;
 #if( portUSING_MPU_WRAPPERS == 1 )
 		/* Should the task be created in privileged mode? */
 		BaseType_t xRunPrivileged;
@@ -2375,6 +2383,9 @@ void vTaskSwitchContext(void) {
 		xYieldPending = pdFALSE;
 		traceTASK_SWITCHED_OUT();
 
+		/* The outgoing task may have printed during its slice */
+		vTaskConsoleDrain();
+
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 		{
 #ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
@@ -2419,7 +2430,6 @@ void vTaskSwitchContext(void) {
 			if(pxCurrentTCB->started)
 			{
 				//printf("Resume Partition %x\r\n",pxCurrentTCB->pxTopOfStack);
-				enableSerialInChild();
 				if(pxCurrentTCB->vidt->flags){
 					Pip_Resume((uint32_t*)pxCurrentTCB->pxTopOfStack,1);
 				}
@@ -2429,9 +2439,7 @@ void vTaskSwitchContext(void) {
 				printf("Starting Partition %x\r\n",pxCurrentTCB->pxTopOfStack);
 				pxCurrentTCB->started = 1;
 				printf("Starting\r\n");
-				enableSerialInChild();
 				Pip_VSTI();
-				startPartition = 1;
 				Pip_Notify((uint32_t) pxCurrentTCB->pxTopOfStack, 0, 0, 0);
 			}
 
@@ -45,9 +45,10 @@ uint32_t receive_simple(char* data, QueueHandle_t xQueue_P2IC){
 	}
 }
 
-void send_simple(char* data, QueueHandle_t xQueue_IC2P, uint32_t datasize){
+void send_simple(char* data, QueueHandle_t xQueue_IC2P, uint32_t datasize, uint32_t link){
 	event_t Event;
 	Event.eventType=NW_OUT;
+	Event.link=link;
 	mymemcpy(Event.eventData.nw.stream, data, datasize);
 	Event.eventData.nw.size=datasize;
 	DEBUG(TRACE, "Internal Communication sent a message\n");
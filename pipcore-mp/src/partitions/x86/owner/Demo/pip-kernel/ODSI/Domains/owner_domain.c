@@ -44,8 +44,6 @@
 
 	printf("Queue are OK\r\n");
 	event_t EventPartition;
-	event_t EventResponse;
-	event_t MessageToReturn;
 	incomingMessage_t Check;
 
 	//char INMES[IN_MAX_MESSAGE_SIZE];
@@ -81,32 +79,30 @@
 		}
 		debug1("\r\n");
 
-		EventResponse = AdminManagerFunction(EventPartition);
+		AdminManagerFunction(&EventPartition);
 
-		eventcpy(&MessageToReturn,&EventResponse);
+		DEBUG(INFO,"IntComm-Response code: %#04X \n", EventPartition.eventData.response.responsecode);
+		DEBUG(INFO, "Data: %s \n", EventPartition.eventData.response.data );
 
-		DEBUG(INFO,"IntComm-Response code: %#04X \n", MessageToReturn.eventData.response.responsecode);
-		DEBUG(INFO, "Data: %s \n", MessageToReturn.eventData.response.data );
-
-		switch(EventResponse.eventType){
+		switch(EventPartition.eventType){
 
 		case INT_RESP_1:
-			xProtectedQueueSend( xQueue_2SP1D, &EventResponse, portMAX_DELAY );
+			xProtectedQueueSend( xQueue_2SP1D, &EventPartition, portMAX_DELAY );
 			break;
 
 		case INT_RESP_2:
-			xProtectedQueueSend( xQueue_2SP2D, &EventResponse, portMAX_DELAY );
+			xProtectedQueueSend( xQueue_2SP2D, &EventPartition, portMAX_DELAY );
 			break;
 
 		case INT_RESP_3:
-			xProtectedQueueSend( xQueue_2SP3D, &EventResponse, portMAX_DELAY );
+			xProtectedQueueSend( xQueue_2SP3D, &EventPartition, portMAX_DELAY );
 			break;
 
 		case RESPONSE:
 			/* Send Data to Network manager*/
 			// TODO move serialization to NW_Manager
-			sizeout=serialize_response(EventResponse.eventData.response, OUTMES);
-			mysend(1, OUTMES, xQueue_2NW, sizeout);
+			sizeout=serialize_response(EventPartition.eventData.response, OUTMES);
+			mysend(1, OUTMES, xQueue_2NW, sizeout, EventPartition.link);
 
 			break;
 
@@ -117,8 +113,6 @@
 		}
 
 		/*Reinitialize events*/
-		eventreset(&MessageToReturn);
-		eventreset(&EventResponse);
 		eventreset(&EventPartition);
 	}
 }
@@ -22,8 +22,7 @@
 
 /*-----------------------------------------------------------*/
 
-// TODO use references instead of copy
-event_t ConfigManagerFunction( event_t ReceivedValue )
+void ConfigManagerFunction( event_t *Event )
 {
 	DEBUG(TRACE,"Config Manager !\n");
 
@@ -40,26 +39,16 @@ event_t ConfigManagerFunction( event_t ReceivedValue )
 	}
 
 	char responseData[100]={};
-	event_t EventToSend;
-	response_t ResponseToSend;
+	int responsecode;
 	responseData[0]='\0';
-	eventreset(&EventToSend);
-	responsereset(&ResponseToSend);
 
-	ResponseToSend.responsecode=ManageDomain(ReceivedValue,&CurrentDomain,responseData);
+	responsecode=ManageDomain(Event,&CurrentDomain,responseData);
 
-	if(responseData[0] != '\0')
-	{
-		strcpy(ResponseToSend.data,responseData);
-	}
-
-	ResponseToSend.userID = ReceivedValue.eventData.command.userID;
-
-	EventToSend.eventType=RESPONSE;
-	responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
-
-	DEBUG(TRACE,"Config-Response code: %#04X, Data: %s\n", ResponseToSend.responsecode, ResponseToSend.data);
+	/* The response overlays the command, userID stays where it is */
+	Event->eventType=RESPONSE;
+	Event->eventData.response.responsecode=responsecode;
+	strcpy(Event->eventData.response.data,responseData);
 
-	return EventToSend;
+	DEBUG(TRACE,"Config-Response code: %#04X, Data: %s\n", Event->eventData.response.responsecode, Event->eventData.response.data);
 }
 
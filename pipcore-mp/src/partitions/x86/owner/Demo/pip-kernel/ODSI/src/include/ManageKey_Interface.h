@@ -8,6 +8,6 @@
 #ifndef INCLUDE_PORTABLE_MANAGEKEY_INTERFACE_H_
 #define INCLUDE_PORTABLE_MANAGEKEY_INTERFACE_H_
 
-int ManageKey(command_t com, key_t **key, char* readData);
+int ManageKey(command_t *com, key_t **key, char* readData);
 
 #endif /* INCLUDE_PORTABLE_MANAGEKEY_INTERFACE_H_ */
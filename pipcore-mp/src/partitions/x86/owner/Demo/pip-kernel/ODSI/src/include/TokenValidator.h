@@ -10,6 +10,6 @@
 
 #include "CommonStructure.h"
 
-event_t TokenValidateFunction( event_t ReceivedValue );
+int TokenValidateFunction( event_t *Event );
 
 #endif /* TOKENVALIDATOR_H_ */
@@ -224,8 +224,6 @@ void od_Task2()
 	QueueHandle_t xQueue_2SP3D = (QueueHandle_t*) queueTab[4];
 
 	event_t EventPartition;
-	event_t EventResponse;
-	event_t MessageToReturn;
 	incomingMessage_t Check;
 
 	char INMES[IN_MAX_MESSAGE_SIZE];
@@ -248,32 +246,30 @@ void od_Task2()
 		}
 		debug1("\r\n");
 
-		EventResponse = AdminManagerFunction(EventPartition);
+		AdminManagerFunction(&EventPartition);
 
-		eventcpy(&MessageToReturn,&EventResponse);
+		DEBUG(INFO,"IntComm-Response code: %#04X \n", EventPartition.eventData.response.responsecode);
+		DEBUG(INFO, "Data: %s \n", EventPartition.eventData.response.data );
 
-		DEBUG(INFO,"IntComm-Response code: %#04X \n", MessageToReturn.eventData.response.responsecode);
-		DEBUG(INFO, "Data: %s \n", MessageToReturn.eventData.response.data );
-
-		switch(EventResponse.eventType){
+		switch(EventPartition.eventType){
 
 		case INT_RESP_1:
-			xQueueSend( xQueue_2SP1D, &EventResponse, portMAX_DELAY );
+			xQueueSend( xQueue_2SP1D, &EventPartition, portMAX_DELAY );
 			break;
 
 		case INT_RESP_2:
-			xQueueSend( xQueue_2SP2D, &EventResponse, portMAX_DELAY );
+			xQueueSend( xQueue_2SP2D, &EventPartition, portMAX_DELAY );
 			break;
 
 		case INT_RESP_3:
-			xQueueSend( xQueue_2SP3D, &EventResponse, portMAX_DELAY );
+			xQueueSend( xQueue_2SP3D, &EventPartition, portMAX_DELAY );
 			break;
 
 		case RESPONSE:
 			/* Send Data to Network manager*/
 			// TODO move serialization to NW_Manager
-			sizeout=serialize_response(EventResponse.eventData.response, OUTMES);
-			mysend(1, OUTMES, xQueue_2NW, sizeout);
+			sizeout=serialize_response(EventPartition.eventData.response, OUTMES);
+			mysend(1, OUTMES, xQueue_2NW, sizeout, EventPartition.link);
 
 			break;
 
@@ -284,8 +280,6 @@ void od_Task2()
 		}
 
 		/*Reinitialize events*/
-		eventreset(&MessageToReturn);
-		eventreset(&EventResponse);
 		eventreset(&EventPartition);
 	}
 }
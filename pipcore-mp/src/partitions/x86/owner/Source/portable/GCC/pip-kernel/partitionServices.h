@@ -35,11 +35,30 @@ struct xQueueReceiveParameters_s {
 typedef struct xQueueReceiveParameters_s xQueueReceiveParameters;
 
 
+/* Items of a batch are packed in data pages, never straddling two pages */
+#define QUEUE_BATCH_MAX_PAGES 8
+struct xQueueBatchParameters_s {
+ uint32_t queue;
+ uint32_t itemSize;
+ uint32_t count;
+ uint32_t tickToWait;
+ uint32_t done;
+ uint32_t pageCount;
+ uint32_t * pages[QUEUE_BATCH_MAX_PAGES];
+};
+typedef struct xQueueBatchParameters_s xQueueBatchParameters;
+
+
 #define queueCreate     0x15
 #define queueSend       0x16
 #define queueReceive    0x17
 #define sbrk            0x18
 #define channelCom      0x19
+#define channelRingOpen   0x1A
+#define channelRingWait   0x1B
+#define channelRingNotify 0x1C
+#define queueSendBatch    0x1D
+#define queueReceiveBatch 0x1E
 
 void initPartitionServices();
 
@@ -0,0 +1,81 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+#include "pip/api.h"
+#include "pip/paging.h"
+#include "pip/compat.h"
+#include "partitionServices.h"
+#include "queueBatch.h"
+
+/* Allocates the parameter page and enough data pages for count items */
+static xQueueBatchParameters * queueBatchPrepare(uint32_t queue, uint32_t itemSize, uint32_t count, uint32_t tickToWait){
+  uint32_t perPage = itemSize ? PGSIZE / itemSize : 0;
+  uint32_t index;
+
+  if(!perPage || !count || count > perPage * QUEUE_BATCH_MAX_PAGES)
+    return 0;
+
+  xQueueBatchParameters * parameters = (xQueueBatchParameters*) allocPage();
+  if(!parameters)
+    return 0;
+  parameters->queue = queue;
+  parameters->itemSize = itemSize;
+  parameters->count = count;
+  parameters->tickToWait = tickToWait;
+  parameters->done = 0;
+  parameters->pageCount = (count + perPage - 1) / perPage;
+
+  for(index=0;index<parameters->pageCount;index++){
+    if(!(parameters->pages[index] = (uint32_t*) allocPage())){
+      while(index--)
+        freePage(parameters->pages[index]);
+      freePage(parameters);
+      return 0;
+    }
+  }
+  return parameters;
+}
+
+static void queueBatchRelease(xQueueBatchParameters * parameters){
+  uint32_t index;
+  for(index=0;index<parameters->pageCount;index++)
+    freePage(parameters->pages[index]);
+  freePage(parameters);
+}
+
+static void * queueBatchItem(xQueueBatchParameters * parameters, uint32_t index){
+  uint32_t perPage = PGSIZE / parameters->itemSize;
+  return (uint8_t*) parameters->pages[index / perPage] + (index % perPage) * parameters->itemSize;
+}
+
+uint32_t xProtectedQueueSendBatch(uint32_t queue, const void * items, uint32_t itemSize, uint32_t count, uint32_t tickToWait){
+  uint32_t index, done;
+  xQueueBatchParameters * parameters = queueBatchPrepare(queue, itemSize, count, tickToWait);
+  if(!parameters)
+    return 0;
+
+  for(index=0;index<count;index++)
+    memcpy(queueBatchItem(parameters, index), (const uint8_t*) items + index * itemSize, itemSize);
+
+  Pip_Notify(0, 0x80, queueSendBatch, (uint32_t) parameters);
+
+  done = parameters->done;
+  queueBatchRelease(parameters);
+  return done;
+}
+
+uint32_t xProtectedQueueReceiveBatch(uint32_t queue, void * buffer, uint32_t itemSize, uint32_t count, uint32_t tickToWait){
+  uint32_t index, done;
+  xQueueBatchParameters * parameters = queueBatchPrepare(queue, itemSize, count, tickToWait);
+  if(!parameters)
+    return 0;
+
+  Pip_Notify(0, 0x80, queueReceiveBatch, (uint32_t) parameters);
+
+  done = parameters->done;
+  for(index=0;index<done;index++)
+    memcpy((uint8_t*) buffer + index * itemSize, queueBatchItem(parameters, index), itemSize);
+  queueBatchRelease(parameters);
+  return done;
+}
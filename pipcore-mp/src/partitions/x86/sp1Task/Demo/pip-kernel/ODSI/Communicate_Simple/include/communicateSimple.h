@@ -14,6 +14,6 @@
 #define COMMUNICATE_SIMPLE_INCLUDE_COMMUNICATESIMPLE_H_
 
 uint32_t receive_simple(char* data, QueueHandle_t xQueue_P2IC);
-void send_simple(char* data, QueueHandle_t xQueue_IC2P, uint32_t datasize);
+void send_simple(char* data, QueueHandle_t xQueue_IC2P, uint32_t datasize, uint32_t link);
 
 #endif /* COMMUNICATE_SIMPLE_INCLUDE_COMMUNICATESIMPLE_H_ */
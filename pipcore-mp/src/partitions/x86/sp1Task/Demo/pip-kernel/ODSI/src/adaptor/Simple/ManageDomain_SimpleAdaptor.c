@@ -19,13 +19,13 @@
 
 /*-----------------------------------------------------------*/
 
-int ManageDomain(event_t com, domain_t *p_dom, char* readData){
-		switch(com.eventData.command.instruction){
+int ManageDomain(event_t *com, domain_t *p_dom, char* readData){
+		switch(com->eventData.command.instruction){
 		case READ_DOMID :
 			return readDomID(p_dom, readData);
 			break;
 		case UPDATE_DOMID :
-			return updateDomID(p_dom,com.eventData.command.data);
+			return updateDomID(p_dom,com->eventData.command.data);
 			break;
 		case CREATE_DOM :
 			return createDomain();
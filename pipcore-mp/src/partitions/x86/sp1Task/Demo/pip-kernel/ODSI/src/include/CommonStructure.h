@@ -62,6 +62,7 @@ typedef enum eventType{
 
 typedef struct event{
 	eventType_t eventType;
+	uint32_t link;		// ESP8266 link of the request, its response goes back there
 	union {
 		incomingMessage_t incomingMessage;
 		command_t command;
@@ -10,6 +10,6 @@
 
 //#include "CommonStructure.h"
 
-int ManageDomain(event_t com, domain_t *dom, char* readData);
+int ManageDomain(event_t *com, domain_t *dom, char* readData);
 
 #endif /* MANAGEDOMAIN_INTERFACE_H_ */
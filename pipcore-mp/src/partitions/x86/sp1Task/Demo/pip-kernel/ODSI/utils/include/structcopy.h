@@ -22,7 +22,11 @@ incomingMessage_t *incomingMessageinit(incomingMessage_t *dest, uint32_t userID,
 response_t * responsecpy(response_t *dest, response_t *src);
 response_t* responsereset(response_t *dest);
 
+uint32_t eventdatasize(event_t *event);
 event_t* eventcpy(event_t *dest, event_t *src);
 event_t* eventreset(event_t *dest);
 
+command_t *commandfrommessage(event_t *event);
+incomingMessage_t *messagefromcommand(event_t *event);
+
 #endif /* UTILS_INCLUDE_STRUCTCOPY_H_ */
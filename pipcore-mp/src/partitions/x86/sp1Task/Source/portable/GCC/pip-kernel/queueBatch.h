@@ -0,0 +1,16 @@
+#ifndef _QUEUE_BATCH_H
+#define _QUEUE_BATCH_H
+#include <stdint.h>
+/*
+ * Batched protected queue calls
+ *
+ * Items are packed into a few pages described by one xQueueBatchParameters
+ * page, so the root moves a whole burst in a single queueSendBatch or
+ * queueReceiveBatch trap instead of one trap per item.
+ * Both calls return the number of items actually moved.
+ */
+
+uint32_t xProtectedQueueSendBatch(uint32_t queue, const void * items, uint32_t itemSize, uint32_t count, uint32_t tickToWait);
+uint32_t xProtectedQueueReceiveBatch(uint32_t queue, void * buffer, uint32_t itemSize, uint32_t count, uint32_t tickToWait);
+
+#endif
@@ -14,9 +14,9 @@
 #ifndef ROUTECOMMANDSIMPLE_H_
 #define ROUTECOMMANDSIMPLE_H_
 
-event_t routeCommandSimple(event_t ReceivedValue);
-event_t routeCommandSimple_SP1D(event_t ReceivedValue);
-event_t routeCommandSimple_SP2D(event_t ReceivedValue);
-event_t routeCommandSimple_SP3D(event_t ReceivedValue);
+void routeCommandSimple(event_t *Event);
+void routeCommandSimple_SP1D(event_t *Event);
+void routeCommandSimple_SP2D(event_t *Event);
+void routeCommandSimple_SP3D(event_t *Event);
 
 #endif /* ROUTECOMMANDSIMPLE_H_ */
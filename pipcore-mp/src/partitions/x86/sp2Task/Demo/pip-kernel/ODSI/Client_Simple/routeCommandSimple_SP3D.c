@@ -29,48 +29,34 @@
 
 /*-----------------------------------------------------------*/
 
-// TODO use references instead of copy
-event_t routeCommandSimple_SP3D(event_t ReceivedValue)
+void routeCommandSimple_SP3D(event_t *Event)
 {
-	event_t ValueToSend;
-	/*Identify the target of command
+	/*Identify the target of command, which answers in place
 	 */
-	eventcpy( &ValueToSend, &ReceivedValue);
-
-	switch(ReceivedValue.eventData.command.instruction){
+	switch(Event->eventData.command.instruction){
 	case READ_DOMID :
 	case UPDATE_DOMID :
 	case CREATE_DOM :
 		DEBUG(TRACE,"call config manager\n");
-
-		return ConfigManagerFunction(ValueToSend);
-
+		ConfigManagerFunction(Event);
 		break;
 	case ADD_KEY:
 	case READ_KEY:
 	case UPDATE_KEY:
 	case DELETE_KEY:
 		DEBUG(TRACE,"call key ring manager\n");
-
-		return KeyManagerFunction(ValueToSend);
-
+		KeyManagerFunction(Event);
 		break;
-
 	case SET_IO:
 	case GET_IO:
 	case SET_IO_DIR:
 	case SET_ALL_IO_DIR:
 	case SET_LED:
 		DEBUG(TRACE,"call LED manager\n");
-
-		return LedManagerFunction(ValueToSend);
-
+		LedManagerFunction(Event);
 		break;
-
 	default:
 		DEBUG(TRACE," Unkown command instruction\n");
-
-		return ValueToSend;
 		break;
 	}
 }
@@ -68,6 +68,6 @@ event_t myreceive(char* data, QueueHandle_t xQueue_P2IC)
 		return EventToReturn;
 }*/
 
-void mysend (uint32_t dest, char* data, QueueHandle_t xQueue_IC2P, uint32_t datasize){
-	send_simple(data, xQueue_IC2P, datasize);
+void mysend (uint32_t dest, char* data, QueueHandle_t xQueue_IC2P, uint32_t datasize, uint32_t link){
+	send_simple(data, xQueue_IC2P, datasize, link);
 }
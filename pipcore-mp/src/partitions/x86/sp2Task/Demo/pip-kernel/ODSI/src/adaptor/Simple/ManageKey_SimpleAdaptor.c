@@ -22,20 +22,20 @@
 /*-----------------------------------------------------------*/
 
 
-int ManageKey(command_t com, key_t** l_key, char* readData){
+int ManageKey(command_t *com, key_t** l_key, char* readData){
 
 	char key_ID[KEYID_SIZE]={};
 	char keyValue[KEY_SIZE]={};
 	int result;
 
 	int i;
-	for(i=0;com.data[i] != ':';i++)
-		key_ID[i]=com.data[i];
+	for(i=0;com->data[i] != ':';i++)
+		key_ID[i]=com->data[i];
 
-	strcpy(keyValue, com.data+i+1);
+	strcpy(keyValue, com->data+i+1);
 
 
-	switch(com.instruction){
+	switch(com->instruction){
 	case ADD_KEY :
 		DEBUG(TRACE,"add Key\n");
 		return addKey(l_key, key_ID, keyValue);
@@ -26,25 +26,24 @@
 
 
 /*-----------------------------------------------------------*/
-// TODO use references instead of copy
-event_t routeCommand(event_t ReceivedValue)
+void routeCommand(event_t *Event)
 {
-	return routeCommandSimple( ReceivedValue);
+	routeCommandSimple( Event );
 }
 
-event_t routeCommand_SP1D(event_t ReceivedValue)
+void routeCommand_SP1D(event_t *Event)
 {
-	return routeCommandSimple_SP1D( ReceivedValue);
+	routeCommandSimple_SP1D( Event );
 }
 
-event_t routeCommand_SP2D(event_t ReceivedValue)
+void routeCommand_SP2D(event_t *Event)
 {
-	return routeCommandSimple_SP2D( ReceivedValue);
+	routeCommandSimple_SP2D( Event );
 }
 
-event_t routeCommand_SP3D(event_t ReceivedValue)
+void routeCommand_SP3D(event_t *Event)
 {
-	return routeCommandSimple_SP3D( ReceivedValue);
+	routeCommandSimple_SP3D( Event );
 }
 /*-----------------------------------------------------------*/
 
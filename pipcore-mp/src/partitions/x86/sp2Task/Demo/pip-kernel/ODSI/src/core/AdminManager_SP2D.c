@@ -22,67 +22,47 @@
 
 /*-----------------------------------------------------------*/
 
-// TODO use references instead of copy
-event_t AdminManager_SP2D_Function( event_t ReceivedEvent )
+void AdminManager_SP2D_Function( event_t *Event )
 {
-
-	event_t ValueToSend;
-	event_t TokenRequest;
-	event_t EventToSend;
-	event_t TokenResponse;
-
-	/*Identify the target of command
+	/*Identify the target of command, the response is built in place
 	 */
 	while(1)
 	{
-		switch(ReceivedEvent.eventType){
+		switch(Event->eventType){
 		case INT_RESP_2:
 			DEBUG(TRACE,"Sending command to destination\r\n");
-			//commandcpy( &ValueToSend.eventData.command , &ReceivedEvent.eventData.incomingMessage.command );
-			//ValueToSend.eventType = INT_RESP_2;
-
 			// TODO implement route Response_SP2D
-			//ReceivedEvent = routeResponse_SP2D( ValueToSend );
-			ReceivedEvent.eventType = RESPONSE;
-
+			//routeResponse_SP2D( Event );
+			Event->eventType = RESPONSE;
 			continue;
 
 		case EXT_MESSAGE:
 			DEBUG(TRACE,"Sending command to token validator\r\n");
-			eventcpy( &TokenRequest , &ReceivedEvent );
-
-			//TokenResponse = TokenValidateFunction(TokenRequest);
 
-			TokenResponse.eventType = RESPONSE;
-			TokenResponse.eventData.response.responsecode = SUCCESS;
+			/* An invalid token turns the message into its response */
+			//if (TokenValidateFunction( Event ) != SUCCESS)
+			//{
+			//	DEBUG(TRACE,"Sending response\r\n");
+			//	return;
+			//}
 
-			if (TokenResponse.eventType == RESPONSE && TokenResponse.eventData.response.responsecode == SUCCESS){
-				DEBUG(TRACE,"Sending command to destination\r\n");
-				commandcpy( &ValueToSend.eventData.command , &ReceivedEvent.eventData.incomingMessage.command );
-				ValueToSend.eventType=EXT_COMMAND;
+			DEBUG(TRACE,"Sending command to destination\r\n");
+			commandfrommessage( Event );
+			Event->eventType=EXT_COMMAND;
 
-				ReceivedEvent = routeCommand_SP2D( ValueToSend );
+			routeCommand_SP2D( Event );
 
-				continue;
-			}
-			else{
-				DEBUG(TRACE,"Sending response\r\n");
-				eventcpy(&EventToSend, &TokenResponse);
+			continue;
 
-				return EventToSend;
-			}
-			break;
 		case EXT_COMMAND:
 			DEBUG(TRACE,"AdminManager: COMMAND Event Type not supported\r\n");
 			break;
 
 		case INT_MESS_0:
-
 		case RESPONSE:
 			DEBUG(TRACE,"Proceeding response\r\n");
-			eventcpy( &EventToSend , &ReceivedEvent );
 
-			return EventToSend;
+			return;
 
 			break;
 		default:
@@ -34,7 +34,6 @@ void InternalCommunicationTask( void *pvParameters )
 
 	event_t EventPartition;
 	event_t EventResponse;
-	event_t MessageToReturn;
 	incomingMessage_t Check;
 
 	char INMES[IN_MAX_MESSAGE_SIZE];
@@ -65,17 +64,14 @@ void InternalCommunicationTask( void *pvParameters )
 
 		switch(EventResponse.eventType){
 		case RESPONSE:
-			eventcpy(&MessageToReturn,&EventResponse);
-
-			DEBUG(INFO,"IntComm-Response code: %#04X \n", MessageToReturn.eventData.response.responsecode);
-			DEBUG(INFO, "Data: %s \n", MessageToReturn.eventData.response.data );
+			DEBUG(INFO,"IntComm-Response code: %#04X \n", EventResponse.eventData.response.responsecode);
+			DEBUG(INFO, "Data: %s \n", EventResponse.eventData.response.data );
 
 			/* Send Data to Network manager*/
 			sizeout=serialize_response(EventResponse.eventData.response, OUTMES);
-			mysend(1, OUTMES, xQueue_2NW, sizeout);
+			mysend(1, OUTMES, xQueue_2NW, sizeout, EventPartition.link);
 
 			/*Reinitialize events*/
-			eventreset(&MessageToReturn);
 			eventreset(&EventResponse);
 			eventreset(&EventPartition);
 			break;
@@ -83,7 +79,6 @@ void InternalCommunicationTask( void *pvParameters )
 		default:
 			DEBUG(TRACE,"Internal Communication: Unknown Event Type\n");
 			/*Reinitialize events*/
-			eventreset(&MessageToReturn);
 			eventreset(&EventResponse);
 			eventreset(&EventPartition);
 			break;
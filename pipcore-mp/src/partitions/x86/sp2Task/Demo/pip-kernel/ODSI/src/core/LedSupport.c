@@ -28,12 +28,11 @@ static void set_IO_value(char *data);
 static int get_IO_value(char *data);
 static void set_IO_dir(char *data);
 static void set_All_IO_dir(char *data);
-static void set_LED_value(event_t *ReceivedValue, event_t *EventToSend);
+static int set_LED_value(event_t *Event);
 
 static uint8_t leds_route_tab[] = { 5, 6, 9, 11};
 
-// TODO use references instead of copy
-event_t LedManagerFunction( event_t ReceivedValue )
+void LedManagerFunction( event_t *Event )
 {
 	static int LED_manager_initialized = 0;
 
@@ -45,92 +44,73 @@ event_t LedManagerFunction( event_t ReceivedValue )
 	}
 
 
-/*	switch(ReceivedValue.eventType)
+/*	switch(Event->eventType)
 	{
 	case INT_RESP_1:
 	case INT_RESP_2:
 	case INT_RESP_3:
-		ReceivedValue.eventType = RESPONSE;
-		return ReceivedValue;
+		Event->eventType = RESPONSE;
+		return;
 
 	default:
 	}*/
 
-	//char responseData[100]={};
-	event_t EventToSend;
-	response_t ResponseToSend;
-	int result;
-
-	//responseData[0]='\0';
-	eventreset(&EventToSend);
-	responsereset(&ResponseToSend);
+	int responsecode = SUCCESS;
 
 	DEBUG(TRACE,"LED Manager !\n");
 
-	ResponseToSend.userID = ReceivedValue.eventData.command.userID;
-
-	ResponseToSend.responsecode= SUCCESS ;
-	strcpy(ResponseToSend.data, "\0");
-
-	switch(ReceivedValue.eventData.command.instruction)
+	switch(Event->eventData.command.instruction)
 	{
 	case SET_IO:
-		set_IO_value(ReceivedValue.eventData.command.data);
-
-		EventToSend.eventType=RESPONSE;
-		responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
+		set_IO_value(Event->eventData.command.data);
+		Event->eventType=RESPONSE;
 
 		break;
 
 	case GET_IO:
-		result = get_IO_value(ReceivedValue.eventData.command.data);
-		if(result == -1)
+		if(get_IO_value(Event->eventData.command.data) == -1)
 		{
-			ResponseToSend.responsecode= GENERAL_ERROR ;
+			responsecode= GENERAL_ERROR ;
 		}
-
-		EventToSend.eventType=RESPONSE;
-		responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
+		Event->eventType=RESPONSE;
 
 		break;
 
 	case SET_IO_DIR:
-		set_IO_dir(ReceivedValue.eventData.command.data);
-
-		EventToSend.eventType=RESPONSE;
-		responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
+		set_IO_dir(Event->eventData.command.data);
+		Event->eventType=RESPONSE;
 
 		break;
 
 	case SET_ALL_IO_DIR:
-		set_All_IO_dir(ReceivedValue.eventData.command.data);
-
-		EventToSend.eventType=RESPONSE;
-		responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
+		set_All_IO_dir(Event->eventData.command.data);
+		Event->eventType=RESPONSE;
 
 		break;
 
 	case SET_LED:
-		//set_LED_value(ReceivedValue.eventData.command.data);
-		commandcpy( &EventToSend.eventData.incomingMessage.command, &ReceivedValue.eventData.command );
-		EventToSend.eventType = INT_MESS_0;
-		EventToSend.eventData.incomingMessage.userID = 1;
-		EventToSend.eventData.incomingMessage.deviceID = 1;
-		EventToSend.eventData.incomingMessage.domainID = 0;
-		EventToSend.eventData.incomingMessage.tokenSize = 0;
+		/* Hand the command over to the owner as an internal message */
+		messagefromcommand(Event);
+		Event->eventType = INT_MESS_0;
+		Event->eventData.incomingMessage.userID = 1;
+		Event->eventData.incomingMessage.deviceID = 1;
+		Event->eventData.incomingMessage.domainID = 0;
+		Event->eventData.incomingMessage.tokenSize = 0;
 
-		break;
+		return;
 
 	default:
 		DEBUG(TRACE," Unknown GPIO command instruction\n");
-		break;
+		eventreset(Event);
+		return;
 	}
 
-	return EventToSend;
+	/* The response overlays the command, userID stays where it is */
+	Event->eventData.response.responsecode= responsecode ;
+	strcpy(Event->eventData.response.data, "\0");
 }
 
-// TODO use references instead of copy
-event_t LedDriverFunction( event_t ReceivedValue )
+void LedDriverFunction( event_t *Event )
 {
 	static int LED_manager_initialized = 0;
 
@@ -141,67 +121,59 @@ event_t LedDriverFunction( event_t ReceivedValue )
 		init_LEDs();
 	}
 
-	//char responseData[100]={};
-	event_t EventToSend;
-	response_t ResponseToSend;
-	int result;
-
-	//responseData[0]='\0';
-	eventreset(&EventToSend);
-	responsereset(&ResponseToSend);
+	int responsecode = SUCCESS;
 
 	DEBUG(TRACE,"LED Manager !\n");
 
-	ResponseToSend.userID = ReceivedValue.eventData.command.userID;
-
-	ResponseToSend.responsecode= SUCCESS ;
-	strcpy(ResponseToSend.data, "\0");
-
-	switch(ReceivedValue.eventData.command.instruction)
+	switch(Event->eventData.command.instruction)
 	{
 	case SET_IO:
-		set_IO_value(ReceivedValue.eventData.command.data);
-		EventToSend.eventType=RESPONSE;
+		set_IO_value(Event->eventData.command.data);
+		Event->eventType=RESPONSE;
 
 		break;
 
 	case GET_IO:
-		result = get_IO_value(ReceivedValue.eventData.command.data);
-		if(result == -1)
+		if(get_IO_value(Event->eventData.command.data) == -1)
 		{
-			ResponseToSend.responsecode= GENERAL_ERROR ;
+			responsecode= GENERAL_ERROR ;
 		}
-		EventToSend.eventType=RESPONSE;
+		Event->eventType=RESPONSE;
 
 		break;
 
 	case SET_IO_DIR:
-		set_IO_dir(ReceivedValue.eventData.command.data);
-		EventToSend.eventType=RESPONSE;
+		set_IO_dir(Event->eventData.command.data);
+		Event->eventType=RESPONSE;
 
 		break;
 
 	case SET_ALL_IO_DIR:
-		set_All_IO_dir(ReceivedValue.eventData.command.data);
-
-		EventToSend.eventType=RESPONSE;
-		responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
+		set_All_IO_dir(Event->eventData.command.data);
+		Event->eventType=RESPONSE;
 
 		break;
 
 	case SET_LED:
-		set_LED_value(&ReceivedValue, &EventToSend);
+		if(set_LED_value(Event) == -1)
+		{
+			/* Rejected data still answers with a reset event, as it always did */
+			uint32_t userID = Event->eventData.command.userID;
+			eventreset(Event);
+			Event->eventData.response.userID = userID;
+		}
 
 		break;
 
 	default:
 		DEBUG(TRACE," Unknown GPIO command instruction\n");
-		break;
+		eventreset(Event);
+		return;
 	}
 
-	responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
-
-	return EventToSend;
+	/* The response overlays the command, userID stays where it is */
+	Event->eventData.response.responsecode= responsecode ;
+	strcpy(Event->eventData.response.data, "\0");
 }
 
 static void set_IO_value(char *data)
@@ -324,14 +296,14 @@ static void set_All_IO_dir(char *data)
 
 }
 
-static void set_LED_value(event_t *ReceivedValue, event_t *EventToSend)
+static int set_LED_value(event_t *Event)
 {
-	char *data = ReceivedValue->eventData.command.data;
+	char *data = Event->eventData.command.data;
 
 	if(data[1] != ',')
 	{
 		DEBUG(TRACE,"[LED Manager] Invalid GPIO command data\n");
-		return;
+		return -1;
 	}
 
 	char string[] = "x";
@@ -344,42 +316,44 @@ static void set_LED_value(event_t *ReceivedValue, event_t *EventToSend)
 	if( led_number > MAX_LED_NUMBER )
 	{
 		DEBUG(TRACE,"[LED Manager] Invalid GPIO number\n");
-		return;
+		return -1;
 	}
 
 	if( io_value > 1 )
 	{
 		DEBUG(TRACE,"[LED Manager] Invalid GPIO value\n");
-		return;
+		return -1;
 	}
 
 	// set io level
 	Galileo_Gen2_Set_IO_Level(leds_route_tab[led_number], io_value);
 
-	if(ReceivedValue->eventType == EXT_COMMAND)
+	if(Event->eventType == EXT_COMMAND)
 	{
-		EventToSend->eventType = RESPONSE;
+		Event->eventType = RESPONSE;
 	}
-	else if(ReceivedValue->eventType == INT_COMMAND)
+	else if(Event->eventType == INT_COMMAND)
 	{
 		switch(led_number)
 		{
 		case 0:
-			EventToSend->eventType = RESPONSE;
+			Event->eventType = RESPONSE;
 			break;
 		case 1:
-			EventToSend->eventType = INT_RESP_1;
+			Event->eventType = INT_RESP_1;
 			break;
 		case 2:
-			EventToSend->eventType = INT_RESP_2;
+			Event->eventType = INT_RESP_2;
 			break;
 		case 3:
-			EventToSend->eventType = INT_RESP_3;
+			Event->eventType = INT_RESP_3;
 			break;
 		default:
 			break;
 		}
 	}
+
+	return 0;
 }
 
 static void init_LEDs()
@@ -10,9 +10,9 @@
 
 #include "CommonStructure.h"
 
-event_t AdminManagerFunction( event_t ReceivedEvent );
-event_t AdminManager_SP1D_Function( event_t ReceivedEvent );
-event_t AdminManager_SP2D_Function( event_t ReceivedEvent );
-event_t AdminManager_SP3D_Function( event_t ReceivedEvent );
+void AdminManagerFunction( event_t *Event );
+void AdminManager_SP1D_Function( event_t *Event );
+void AdminManager_SP2D_Function( event_t *Event );
+void AdminManager_SP3D_Function( event_t *Event );
 
 #endif /* ADMINMANAGER_H_ */
@@ -9,6 +9,6 @@
 #define INCLUDE_CORE_KEYMANAGER_H_
 #include "CommonStructure.h"
 
-event_t KeyManagerFunction( event_t ReceivedValue );
+void KeyManagerFunction( event_t *Event );
 
 #endif /* INCLUDE_CORE_KEYMANAGER_H_ */
@@ -10,6 +10,6 @@
 
 #include "CommonStructure.h"
 
-event_t LedDriverFunction( event_t ReceivedValue );
+void LedDriverFunction( event_t *Event );
 
 #endif /* SRC_INCLUDE_LEDDRIVER_H_ */
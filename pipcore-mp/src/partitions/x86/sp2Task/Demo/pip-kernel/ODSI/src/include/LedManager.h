@@ -10,6 +10,6 @@
 
 #include "CommonStructure.h"
 
-event_t LedManagerFunction( event_t ReceivedValue );
+void LedManagerFunction( event_t *Event );
 
 #endif /* SRC_INCLUDE_LEDDRIVER_H_ */
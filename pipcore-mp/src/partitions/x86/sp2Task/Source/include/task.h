@@ -2052,6 +2052,7 @@ void *pvTaskIncrementMutexHeldCount( void ) PRIVILEGED_FUNCTION;
 
 
 uint32_t xTaskSwitchToProtectedTask();
+void vTaskConsoleDrain();
 
 
 #ifdef __cplusplus
@@ -48,8 +48,6 @@ SP3D_Task( uint32_t *pvParameters )
 	QueueHandle_t xQueue_2SP3D =(QueueHandle_t) pvParameters[2];
 
 	event_t EventPartition;
-	event_t EventResponse;
-	event_t MessageToReturn;
 	incomingMessage_t Check;
 
 	char * INMES = (char*)allocPage();
@@ -74,24 +72,22 @@ SP3D_Task( uint32_t *pvParameters )
 		}
 		debug1("\n");
 
-		EventResponse = AdminManager_SP3D_Function(EventPartition);
+		AdminManager_SP3D_Function(&EventPartition);
 
-		eventcpy(&MessageToReturn,&EventResponse);
+		DEBUG(INFO,"IntComm-Response code: %#04X \n", EventPartition.eventData.response.responsecode);
+		DEBUG(INFO, "Data: %s \n", EventPartition.eventData.response.data );
 
-		DEBUG(INFO,"IntComm-Response code: %#04X \n", MessageToReturn.eventData.response.responsecode);
-		DEBUG(INFO, "Data: %s \n", MessageToReturn.eventData.response.data );
-
-		switch(EventResponse.eventType){
+		switch(EventPartition.eventType){
 		case INT_MESS_0:
-			xProtectedQueueSend(xQueue_2OD_IC, &EventResponse, portMAX_DELAY);
+			xProtectedQueueSend(xQueue_2OD_IC, &EventPartition, portMAX_DELAY);
 			//mysend(1, OUTMES, xQueue_2OD_IC, sizeout);
 
 			break;
 
 		case RESPONSE:
 			/* Send Data to Network manager*/
-			sizeout=serialize_response(EventResponse.eventData.response, OUTMES);
-			mysend(1, OUTMES, xQueue_2NW, sizeout);
+			sizeout=serialize_response(EventPartition.eventData.response, OUTMES);
+			mysend(1, OUTMES, xQueue_2NW, sizeout, EventPartition.link);
 
 			break;
 
@@ -102,8 +98,6 @@ SP3D_Task( uint32_t *pvParameters )
 		}
 
 		/*Reinitialize events*/
-		eventreset(&MessageToReturn);
-		eventreset(&EventResponse);
 		eventreset(&EventPartition);
 	}
 }
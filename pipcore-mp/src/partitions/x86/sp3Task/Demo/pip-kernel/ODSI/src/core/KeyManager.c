@@ -23,8 +23,7 @@
 
 /*-----------------------------------------------------------*/
 
-// TODO use references instead of copy
-event_t KeyManagerFunction( event_t ReceivedValue )
+void KeyManagerFunction( event_t *Event )
 {
 
 	DEBUG(TRACE,"Hello! I am the Key Manager !\r\n");
@@ -37,7 +36,7 @@ event_t KeyManagerFunction( event_t ReceivedValue )
 	{
 		key_manager_initialized = 1;
 		command_t InitValue={0,ADD_KEY,"1:17"};
-		ManageKey(InitValue, &List_TokenKey, NULL);
+		ManageKey(&InitValue, &List_TokenKey, NULL);
 		DEBUG(TRACE,"Initialize Token Key List\r\n");
 	}
 
@@ -45,48 +44,31 @@ event_t KeyManagerFunction( event_t ReceivedValue )
 	strcpy(responseData,"\0");
 
 	uint32_t result = 0;
-	event_t EventToSend;
-	response_t ResponseToSend;
-	eventreset(&EventToSend);
-	responsereset(&ResponseToSend);
 
-	switch(ReceivedValue.eventType){
+	switch(Event->eventType){
 	case GET_KEY:
-		result = ManageKey(ReceivedValue.eventData.command, &List_TokenKey, responseData);
+		result = ManageKey(&Event->eventData.command, &List_TokenKey, responseData);
 		DEBUG(TRACE,"Get key for token validation: Result : %#04X. Data: %s\r\n", result, responseData);
 
-		ResponseToSend.userID = ReceivedValue.eventData.command.userID;
-		strcpy(ResponseToSend.data,responseData);
-		ResponseToSend.responsecode= result ;
-
-		EventToSend.eventType=RESPONSE;
-		responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
-
-		return EventToSend;
-
 		break;
 	case EXT_COMMAND:
-		result = ManageKey(ReceivedValue.eventData.command, &List_TokenKey, responseData);
+		result = ManageKey(&Event->eventData.command, &List_TokenKey, responseData);
 
 		DEBUG(TRACE,"Manage Key: Result : %#04X. Data: %s\r\n", result, responseData);
 
-		ResponseToSend.userID = ReceivedValue.eventData.command.userID;
-		strcpy(ResponseToSend.data,responseData);
-		ResponseToSend.responsecode= result ;
-
-		EventToSend.eventType=RESPONSE;
-		responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
-
-		return EventToSend;
-
 		break;
 	case EXT_MESSAGE :
 	case RESPONSE :
 	default :
 		DEBUG(INFO, "KeyManager: Unknown Event Type\r\n");
-		return EventToSend;
-		break;
+		eventreset(Event);
+		return;
 	}
+
+	/* The response overlays the command, userID stays where it is */
+	Event->eventType=RESPONSE;
+	Event->eventData.response.responsecode= result ;
+	strcpy(Event->eventData.response.data,responseData);
 }
 
 
@@ -107,7 +89,7 @@ void KeyManagerTask( void *pvParameters ){
 	DEBUG(TRACE,"Initialize Token Key List\n");
 
 	command_t InitValue={0,ADD_KEY,"1:17"};
-	ManageKey(InitValue, &List_TokenKey, NULL);
+	ManageKey(&InitValue, &List_TokenKey, NULL);
 
 	/* Remove compiler warning in the case that configASSERT() is not
 	defined.*/
@@ -130,7 +112,7 @@ void KeyManagerTask( void *pvParameters ){
 
 		switch(ReceivedValue.eventType){
 		case GET_KEY:
-			result = ManageKey(ReceivedValue.eventData.command, &List_TokenKey, responseData);
+			result = ManageKey(&ReceivedValue.eventData.command, &List_TokenKey, responseData);
 			DEBUG(TRACE,"Get key for token validation: Result : %#04X. Data: %s\n", result, responseData);
 
 			ResponseToSend.userID = ReceivedValue.eventData.command.userID;
@@ -143,7 +125,7 @@ void KeyManagerTask( void *pvParameters ){
 			xQueueSend( xQueue_2TV, &EventToSend, 0U );
 			break;
 		case EXT_COMMAND:
-			result = ManageKey(ReceivedValue.eventData.command, &List_TokenKey, responseData);
+			result = ManageKey(&ReceivedValue.eventData.command, &List_TokenKey, responseData);
 
 			DEBUG(TRACE,"Manage Key: Result : %#04X. Data: %s\n", result, responseData);
 
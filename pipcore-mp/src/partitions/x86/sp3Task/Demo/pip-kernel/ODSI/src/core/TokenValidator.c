@@ -22,63 +22,42 @@
 
 /*-----------------------------------------------------------*/
 
-// TODO use references instead of copy
-event_t TokenValidateFunction( event_t ReceivedValue )
+/* Leaves a message with a valid token untouched for routing, otherwise turns
+ * it into its response in place. Returns the response code. */
+int TokenValidateFunction( event_t *Event )
 {
-	response_t ResponseToSend;
-	event_t EventToSend;
 	event_t KeyRequest;
-	event_t KeyResponse;
 	char result;
 
-	responsereset(&ResponseToSend);
-	eventreset(&EventToSend);
-	eventreset(&KeyRequest);
-	eventreset(&KeyResponse);
-
 	DEBUG(TRACE,"Hello! I am the token Validator !\r\n");
 
-	switch(ReceivedValue.eventType){
+	switch(Event->eventType){
 	case EXT_MESSAGE:
-		KeyRequest.eventType=GET_KEY;
-		incomingMessagecpy(&KeyRequest.eventData.incomingMessage, &ReceivedValue.eventData.incomingMessage);
-
 		/*Create a command to request the key value*/
+		eventreset(&KeyRequest);
+		KeyRequest.eventType=GET_KEY;
+		KeyRequest.eventData.command.userID=Event->eventData.incomingMessage.userID;
 		KeyRequest.eventData.command.instruction=READ_KEY;
 		strcpy( KeyRequest.eventData.command.data , "1:" );
 
-		KeyResponse = KeyManagerFunction(KeyRequest);
+		KeyManagerFunction(&KeyRequest);
 
 		/*Validate the token received */
 
-		result=token_validate(ReceivedValue.eventData.incomingMessage.token, KeyResponse.eventData.response.data);
-
-		/* Send to the queue - causing the Administration Manager to unblock,
-		 * send the command to the expected target for processing
-		 * 0 is used as the block time so the sending operation
-		 * will not block - it shouldn't need to block as the queue should always
-		 * be empty at this point in the code. */
+		result=token_validate(Event->eventData.incomingMessage.token, KeyRequest.eventData.response.data);
 
 		if(result == 1){
 			DEBUG(TRACE,"Token is valid\r\n");
-			EventToSend.eventType=RESPONSE;
-			EventToSend.eventData.incomingMessage.userID=ResponseToSend.userID;
-			ResponseToSend.responsecode= SUCCESS ;
-
-			responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
-
-			return EventToSend;
+			return SUCCESS;
 		}
 		else{
 			DEBUG(TRACE,"Token is not valid\r\n");
-			ResponseToSend.userID=ReceivedValue.eventData.incomingMessage.userID;
-			strcpy(ResponseToSend.data, "\0");
-			ResponseToSend.responsecode= INVALID_TOKEN ;
+			/* userID already sits where the response expects it */
+			Event->eventType=RESPONSE;
+			Event->eventData.response.responsecode= INVALID_TOKEN ;
+			strcpy(Event->eventData.response.data, "\0");
 
-			EventToSend.eventType=RESPONSE;
-			responsecpy(&(EventToSend.eventData.response), &(ResponseToSend));
-
-			return EventToSend;
+			return INVALID_TOKEN;
 		}
 		break;
 	case EXT_COMMAND :
@@ -89,6 +68,5 @@ event_t TokenValidateFunction( event_t ReceivedValue )
 		break;
 	}
 
-	return EventToSend;
+	return GENERAL_ERROR;
 }
-
@@ -10,7 +10,7 @@
 
 #include "CommonStructure.h"
 
-event_t ConfigManagerFunction( event_t ReceivedValue );
+void ConfigManagerFunction( event_t *Event );
 
 #endif /* CONFIGMANAGER_H_ */
 
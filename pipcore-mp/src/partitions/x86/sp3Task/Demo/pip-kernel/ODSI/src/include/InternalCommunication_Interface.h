@@ -16,7 +16,7 @@
 
 event_t myreceive(char* data, QueueHandle_t xQueue_P2IC);
 
-void mysend (uint32_t dest, char* data, QueueHandle_t xQueue_IC2P, uint32_t datasize);
+void mysend (uint32_t dest, char* data, QueueHandle_t xQueue_IC2P, uint32_t datasize, uint32_t link);
 
 
 #endif /* SRC_INCLUDE_INTERNALCOMMUNICATION_INTERFACE_H_ */
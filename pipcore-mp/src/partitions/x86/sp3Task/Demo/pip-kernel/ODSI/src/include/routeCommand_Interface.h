@@ -13,9 +13,9 @@
 #ifndef ROUTECOMMAND_INTERFACE_H_
 #define ROUTECOMMAND_INTERFACE_H_
 
-event_t routeCommand(event_t ReceivedValue);
-event_t routeCommand_SP1D(event_t ReceivedValue);
-event_t routeCommand_SP2D(event_t ReceivedValue);
-event_t routeCommand_SP3D(event_t ReceivedValue);
+void routeCommand(event_t *Event);
+void routeCommand_SP1D(event_t *Event);
+void routeCommand_SP2D(event_t *Event);
+void routeCommand_SP3D(event_t *Event);
 
 #endif /* ROUTECOMMAND_INTERFACE_H_ */
@@ -9,6 +9,7 @@
 #include "CommonStructure.h"
 #include "string.h"
 #include "stdint.h"
+#include "stddef.h"
 #include "mystdlib.h"
 #include "string.h"
 
@@ -87,20 +88,81 @@ response_t* responsereset(response_t *dest){
 	return dest;
 }
 
+/* Length of a data string including its terminator, bounded by the field */
+static uint32_t datalen(const char *data){
+	uint32_t len = 0;
+
+	while(len < DATA_SIZE - 1 && data[len] != '\0')
+		len++;
+	return len + 1;
+}
+
+/* Bytes of the union that are live for the event type. The members alias the
+ * same storage, so only the one selected by eventType is worth copying. */
+uint32_t eventdatasize(event_t *event){
+	uint32_t size;
+
+	switch(event->eventType){
+	case NW_IN:
+	case NW_OUT:
+		size = event->eventData.nw.size;
+		if(size > IN_MAX_MESSAGE_SIZE)
+			size = IN_MAX_MESSAGE_SIZE;
+		return offsetof(in_nw_t, stream) + size;
+	case GET_KEY:
+	case EXT_COMMAND:
+	case INT_COMMAND:
+		return offsetof(command_t, data) + datalen(event->eventData.command.data);
+	case EXT_MESSAGE:
+	case INT_MESS_0:
+	case INT_MESS_1:
+	case INT_MESS_2:
+	case INT_MESS_3:
+		return offsetof(incomingMessage_t, command) + offsetof(command_t, data)
+			+ datalen(event->eventData.incomingMessage.command.data);
+	case RESPONSE:
+	case INT_RESP_0:
+	case INT_RESP_1:
+	case INT_RESP_2:
+	case INT_RESP_3:
+		return offsetof(response_t, data) + datalen(event->eventData.response.data);
+	default:
+		return sizeof(event->eventData);
+	}
+}
+
 event_t * eventcpy(event_t *dest, event_t *src){
 	dest->eventType=src->eventType;
-	commandcpy(&dest->eventData.command,&src->eventData.command);
-	incomingMessagecpy(&dest->eventData.incomingMessage,&src->eventData.incomingMessage);
-	responsecpy(&dest->eventData.response,&src->eventData.response);
-	strcpy(dest->eventData.nw.stream, src->eventData.nw.stream);
+	dest->link=src->link;
+	mymemcpy(&dest->eventData, &src->eventData, eventdatasize(src));
 	return dest;
 }
 
+/* Only the header is cleared, an unknown type marks the whole union as dead */
 event_t * eventreset(event_t *dest){
 	dest->eventType=0xFF;
-	commandreset(&dest->eventData.command);
-	incomingMessagereset(&dest->eventData.incomingMessage);
-	responsereset(&dest->eventData.response);
-	strcpy(dest->eventData.nw.stream,"\0");
+	dest->eventData.nw.size=0;
 	return dest;
 }
+
+/* The command of an incoming message lies after the message header, so moving
+ * it to the head of the union (or back) overlaps: copy in the safe direction. */
+command_t *commandfrommessage(event_t *event){
+	char *dest = (char*) &event->eventData.command;
+	char *src = (char*) &event->eventData.incomingMessage.command;
+	uint32_t i;
+
+	for(i = 0; i < sizeof(command_t); i++)
+		dest[i] = src[i];
+	return &event->eventData.command;
+}
+
+incomingMessage_t *messagefromcommand(event_t *event){
+	char *dest = (char*) &event->eventData.incomingMessage.command;
+	char *src = (char*) &event->eventData.command;
+	uint32_t i;
+
+	for(i = sizeof(command_t); i > 0; i--)
+		dest[i - 1] = src[i - 1];
+	return &event->eventData.incomingMessage;
+}
@@ -192,6 +192,8 @@ uint32_t * queueTab;
 void main()
 {
 
+  /* Print through the console page the root drains, the UART is not ours */
+  Pip_Debug_SetConsole((Pip_Console*)0xFFFFD000);
   pip_fpinfo * bootinfo = (pip_fpinfo*)0xFFFFC000;
   //Get Bootinfo for the available memory
   parse_bootinfo(bootinfo);
@@ -0,0 +1,178 @@
+/* Standard includes. */
+#include <stdint.h>
+#include <string.h>
+
+#include "pip/api.h"
+#include "pip/compat.h"
+#include "partitionServices.h"
+#include "sharedChannel.h"
+
+/* x86 keeps stores in order, only the compiler has to be told not to reorder */
+#define ringCompilerBarrier()   __asm__ volatile("" ::: "memory")
+
+/* Slots of a partition's ring, reached through its contiguous mapping */
+#define ringSlot(ring, index) \
+  ((uint8_t*) (ring) + sharedRingSlotPage(index, (ring)->slotSize, (ring)->length) * SHARED_CHANNEL_PAGE \
+   + sharedRingSlotOffset(index, (ring)->slotSize, (ring)->length))
+
+/* Slots of a ring as seen by the root, one page at a time */
+#define viewSlot(channel, pages, index) \
+  ((pages)[sharedRingSlotPage(index, (channel)->slotSize, (channel)->length)] \
+   + sharedRingSlotOffset(index, (channel)->slotSize, (channel)->length))
+
+uint32_t sharedRingSlotSize(uint32_t itemSize){
+  return (itemSize + SHARED_CHANNEL_CACHE_LINE - 1) & ~(SHARED_CHANNEL_CACHE_LINE - 1);
+}
+
+/* Header page, then the slot pages. itemSize must not exceed a page */
+uint32_t sharedRingPages(uint32_t itemSize, uint32_t length){
+  uint32_t perPage = SHARED_CHANNEL_PAGE / sharedRingSlotSize(itemSize);
+  return 1 + (length + perPage - 1) / perPage;
+}
+
+void sharedRingInit(sharedRing_t * ring, uint32_t id, uint32_t itemSize, uint32_t length){
+  ring->id = id;
+  ring->itemSize = itemSize;
+  ring->slotSize = sharedRingSlotSize(itemSize);
+  ring->length = length;
+  ring->head = 0;
+  ring->tail = 0;
+  ring->producerWaiting = 0;
+  ring->consumerWaiting = 0;
+  ringCompilerBarrier();
+  ring->magic = SHARED_CHANNEL_MAGIC;
+}
+
+uint32_t sharedRingCount(sharedRing_t * ring){
+  return ring->head - ring->tail;
+}
+
+uint32_t sharedRingPush(sharedRing_t * ring, const void * item){
+  uint32_t head = ring->head;
+  if(head - ring->tail >= ring->length)
+    return 0;
+  memcpy(ringSlot(ring, head), item, ring->itemSize);
+  /* The slot must be visible before the consumer sees the new head */
+  ringCompilerBarrier();
+  ring->head = head + 1;
+  return 1;
+}
+
+uint32_t sharedRingPop(sharedRing_t * ring, void * item){
+  uint32_t tail = ring->tail;
+  if(ring->head == tail)
+    return 0;
+  ringCompilerBarrier();
+  memcpy(item, ringSlot(ring, tail), ring->itemSize);
+  /* The slot must be read before the producer may overwrite it */
+  ringCompilerBarrier();
+  ring->tail = tail + 1;
+  return 1;
+}
+
+/* Moves what it can from the producer's ring to the consumer's ring, one
+ * copy each. Indexes live in child-writable pages: each is read once and
+ * clamped to the channel length, so a hostile child can neither steer the
+ * copy out of its ring nor keep the root relaying. */
+uint32_t sharedChannelRelay(sharedChannelView_t * channel){
+  sharedRing_t * tx = (sharedRing_t*) channel->tx[0];
+  sharedRing_t * rx = (sharedRing_t*) channel->rx[0];
+  uint32_t txTail, rxHead, available, space, moved;
+
+  if(!tx || !rx)
+    return 0;
+  txTail = tx->tail;
+  rxHead = rx->head;
+  available = tx->head - txTail;
+  space = channel->length - (rxHead - rx->tail);
+  if(available > channel->length)
+    available = channel->length;
+  if(space > channel->length)
+    space = 0;
+  ringCompilerBarrier();
+  for(moved=0;moved<available && moved<space;moved++)
+    memcpy(viewSlot(channel, channel->rx, rxHead + moved),
+           viewSlot(channel, channel->tx, txTail + moved),
+           channel->itemSize);
+  ringCompilerBarrier();
+  rx->head = rxHead + moved;
+  tx->tail = txTail + moved;
+  return moved;
+}
+
+static uint32_t channelWaitTicks(uint32_t tickToWait){
+  return tickToWait > SHARED_CHANNEL_MAX_WAIT ? SHARED_CHANNEL_MAX_WAIT : tickToWait;
+}
+
+sharedRing_t * xProtectedChannelOpen(uint32_t id, uint32_t role, uint32_t itemSize, uint32_t length, uint32_t vaddr){
+
+  /* Ring indexes are free running, the length has to divide 2^32 */
+  if(!length || (length & (length - 1)) || id >= SHARED_CHANNEL_MAX)
+    return 0;
+  if(!itemSize || itemSize > SHARED_CHANNEL_PAGE || sharedRingPages(itemSize, length) > SHARED_CHANNEL_MAX_PAGES)
+    return 0;
+
+  xChannelOpenParameters * parameters = (xChannelOpenParameters*) allocPage();
+  if(!parameters)
+    return 0;
+  parameters->id = id;
+  parameters->role = role;
+  parameters->itemSize = itemSize;
+  parameters->length = length;
+  parameters->vaddr = vaddr;
+  parameters->returnCall = 0;
+
+  Pip_Notify(0, 0x80, channelRingOpen, (uint32_t) parameters);
+
+  sharedRing_t * ring = (sharedRing_t*) parameters->returnCall;
+  freePage(parameters);
+  if(!ring || ring->magic != SHARED_CHANNEL_MAGIC)
+    return 0;
+  return ring;
+}
+
+uint32_t xProtectedChannelSend(sharedRing_t * channel, const void * item, uint32_t tickToWait){
+
+  while(!sharedRingPush(channel, item)){
+    if(!tickToWait)
+      return 0;
+    /* Publish the wait before the last check, the root reads it on relay */
+    channel->producerWaiting = 1;
+    __sync_synchronize();
+    if(sharedRingPush(channel, item)){
+      channel->producerWaiting = 0;
+      break;
+    }
+    Pip_Notify(0, 0x80, channelRingWait, SHARED_CHANNEL_WAIT_ARG(channel->id, channelWaitTicks(tickToWait)));
+    channel->producerWaiting = 0;
+    tickToWait = 0;
+  }
+
+  /* Only ring the doorbell when the consumer sleeps in the root, otherwise
+   * it pulls the item itself once its own ring is empty */
+  __sync_synchronize();
+  if(channel->consumerWaiting)
+    Pip_Notify(0, 0x80, channelRingNotify, channel->id);
+  return 1;
+}
+
+uint32_t xProtectedChannelReceive(sharedRing_t * channel, void * buffer, uint32_t tickToWait){
+
+  while(!sharedRingPop(channel, buffer)){
+    if(!tickToWait){
+      /* Pull whatever the producer left in its ring */
+      Pip_Notify(0, 0x80, channelRingNotify, channel->id);
+      return sharedRingPop(channel, buffer);
+    }
+    channel->consumerWaiting = 1;
+    __sync_synchronize();
+    if(sharedRingPop(channel, buffer)){
+      channel->consumerWaiting = 0;
+      return 1;
+    }
+    Pip_Notify(0, 0x80, channelRingWait, SHARED_CHANNEL_WAIT_ARG(channel->id, channelWaitTicks(tickToWait)));
+    channel->consumerWaiting = 0;
+    tickToWait = 0;
+  }
+  return 1;
+}
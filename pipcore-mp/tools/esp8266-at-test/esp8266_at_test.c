@@ -0,0 +1,296 @@
+/*
+ * esp8266_at_test.c
+ *
+ * Host-side check and benchmark of the NetworkMngr ESP8266 AT recognizer.
+ * A captured ESP8266 session is replayed as the UART DMA ring would hand it
+ * out, in random chunk sizes, and the emitted events and link numbers are
+ * compared with the expected list. "+IPD," segments are skipped the way
+ * rcv_tcp_segment() reads them, so their payload never reaches the
+ * recognizer. The same session, repeated, is then timed in one pass.
+ *
+ * usage: esp8266_at_test <session> <events>
+ *        esp8266_at_test -o, built with a trie too small for the tokens
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <esp8266_at.h>
+
+#define MAX_EVENTS				256
+#define SEEDS					1000
+#define MAX_CHUNK				64
+#define BENCH_SIZE				(4 * 1024 * 1024)
+#define NO_CHECK				0xFE	// the expected event does not give a link
+
+typedef struct
+{
+	uint8_t event;
+	uint8_t link;
+} event_t;
+
+static const char *event_names[] =
+{
+	"NONE", "OK", "ERROR", "SEND_OK", "SEND_FAIL", "BUSY", "RECV", "LINK_INVALID",
+	"CONNECT", "CONNECT_FAIL", "CLOSED", "WIFI_CONNECTED", "WIFI_DISCONNECT",
+	"WIFI_GOT_IP", "PROMPT", "IPD", "UNKNOWN",
+};
+
+static char *read_file(const char *path, unsigned long *size)
+{
+	FILE *f = fopen(path, "rb");
+	char *data;
+	long length;
+
+	if(!f)
+	{
+		perror(path);
+		exit(2);
+	}
+	fseek(f, 0, SEEK_END);
+	length = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	data = malloc(length + 1);
+	if(!data || fread(data, 1, length, f) != (size_t) length)
+	{
+		fprintf(stderr, "%s: read failed\n", path);
+		exit(2);
+	}
+	fclose(f);
+	data[length] = '\0';
+	*size = length;
+	return data;
+}
+
+static int read_events(const char *path, event_t *events)
+{
+	unsigned long size;
+	char *data = read_file(path, &size);
+	char *line, *end, name[32];
+	int count = 0, fields;
+	unsigned int i, link;
+
+	for(line = data; *line; line = end)
+	{
+		end = strchr(line, '\n');
+		end = end ? end + 1 : line + strlen(line);
+		fields = sscanf(line, "%31s %u", name, &link);
+		if(fields < 1)
+		{
+			continue;
+		}
+
+		for(i = 1; i < sizeof(event_names) / sizeof(event_names[0]); i++)
+		{
+			if(strcmp(name, event_names[i]) == 0)
+			{
+				break;
+			}
+		}
+		if(i == sizeof(event_names) / sizeof(event_names[0]) || count == MAX_EVENTS)
+		{
+			fprintf(stderr, "%s: bad event \"%s\"\n", path, name);
+			exit(2);
+		}
+		events[count].event = i;
+		events[count].link = fields == 2 ? link : NO_CHECK;
+		count++;
+	}
+
+	free(data);
+	return count;
+}
+
+/*
+ * Skips "<link>,<length>:<payload>" after a "+IPD," event.
+ *
+ * @return the offset past the payload, 0 if the header is malformed
+ */
+static unsigned long skip_segment(const char *data, unsigned long size, unsigned long at)
+{
+	unsigned long length = 0;
+
+	while(at < size && data[at] >= '0' && data[at] <= '9')
+	{
+		at++;
+	}
+	if(at >= size || data[at++] != ',')
+	{
+		return 0;
+	}
+	while(at < size && data[at] >= '0' && data[at] <= '9')
+	{
+		length = length * 10 + data[at++] - '0';
+	}
+	if(at >= size || data[at++] != ':' || at + length > size)
+	{
+		return 0;
+	}
+	return at + length;
+}
+
+/*
+ * Feeds the session as the DMA ring would fill, chunk bytes more each time.
+ * chunk is 0 to feed it all at once.
+ *
+ * @return the number of events, -1 on a malformed segment
+ */
+static int replay(const char *data, unsigned long size, unsigned long chunk, event_t *events, int max)
+{
+	esp8266_at_t at;
+	unsigned long at_byte = 0, available = 0, used;
+	uint8_t event;
+	int count = 0;
+
+	esp8266_at_init(&at);
+
+	while(at_byte < size)
+	{
+		available += chunk ? (unsigned long) (rand() % chunk) + 1 : size;
+		if(available > size)
+		{
+			available = size;
+		}
+
+		while(at_byte < available)
+		{
+			used = esp8266_at_feed(&at, data + at_byte, available - at_byte, &event);
+			at_byte += used;
+			if(event == ESP8266_AT_NONE)
+			{
+				continue;
+			}
+
+			if(count < max)
+			{
+				events[count].event = event;
+				events[count].link = at.link;
+			}
+			count++;
+
+			if(event == ESP8266_AT_IPD)
+			{
+				at_byte = skip_segment(data, size, at_byte);
+				if(at_byte == 0)
+				{
+					return -1;
+				}
+				if(available < at_byte)
+				{
+					available = at_byte;
+				}
+			}
+		}
+	}
+
+	return count;
+}
+
+static int compare(const event_t *expected, int expected_count, const event_t *got, int got_count, unsigned long chunk, unsigned int seed)
+{
+	int i;
+
+	for(i = 0; i < expected_count || i < got_count; i++)
+	{
+		if(i >= expected_count || i >= got_count || got[i].event != expected[i].event
+		   || (expected[i].link != NO_CHECK && got[i].link != expected[i].link))
+		{
+			fprintf(stderr, "chunk %lu seed %u: event %d is %s %u, expected %s %u\n", chunk, seed, i,
+					i < got_count ? event_names[got[i].event] : "nothing", i < got_count ? got[i].link : 0,
+					i < expected_count ? event_names[expected[i].event] : "nothing", i < expected_count ? expected[i].link : 0);
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static int check(const char *session, unsigned long size, const event_t *expected, int expected_count)
+{
+	event_t got[MAX_EVENTS];
+	unsigned long chunk;
+	unsigned int seed;
+	int count;
+
+	for(chunk = 0; chunk <= MAX_CHUNK; chunk++)
+	{
+		for(seed = 0; seed < (chunk ? SEEDS : 1); seed++)
+		{
+			srand(seed);
+			count = replay(session, size, chunk, got, MAX_EVENTS);
+			if(count < 0)
+			{
+				fprintf(stderr, "chunk %lu seed %u: malformed +IPD segment\n", chunk, seed);
+				return 1;
+			}
+			if(compare(expected, expected_count, got, count > MAX_EVENTS ? MAX_EVENTS : count, chunk, seed))
+			{
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+static void bench(const char *session, unsigned long size, int session_events)
+{
+	char *data = malloc(BENCH_SIZE);
+	unsigned long filled = 0;
+	struct timespec start, stop;
+	double ns;
+	int count;
+
+	while(filled + size <= BENCH_SIZE)
+	{
+		memcpy(data + filled, session, size);
+		filled += size;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	count = replay(data, filled, 0, NULL, 0);
+	clock_gettime(CLOCK_MONOTONIC, &stop);
+
+	ns = (stop.tv_sec - start.tv_sec) * 1e9 + (stop.tv_nsec - start.tv_nsec);
+	printf("bench: %lu bytes, %d events (%s) in %.0f us, %.2f ns/byte, %.0f MB/s\n",
+		   filled, count, count == (int) (filled / size) * session_events ? "ok" : "MISMATCH",
+		   ns / 1000, ns / filled, filled / ns * 1000);
+	free(data);
+}
+
+int main(int argc, char **argv)
+{
+	esp8266_at_t at;
+	event_t expected[MAX_EVENTS];
+	unsigned long size;
+	char *session;
+	int count;
+
+	if(argc == 2 && strcmp(argv[1], "-o") == 0)
+	{
+		if(esp8266_at_init(&at) != -1)
+		{
+			fprintf(stderr, "overflow: esp8266_at_init accepted a trie too small\n");
+			return 1;
+		}
+		printf("overflow: ok\n");
+		return 0;
+	}
+	if(argc != 3)
+	{
+		fprintf(stderr, "usage: %s <session> <events> | -o\n", argv[0]);
+		return 2;
+	}
+
+	session = read_file(argv[1], &size);
+	count = read_events(argv[2], expected);
+
+	if(check(session, size, expected, count))
+	{
+		return 1;
+	}
+	printf("events: ok, %d events, chunks of 1 to %d bytes, %d seeds each\n", count, MAX_CHUNK, SEEDS);
+
+	bench(session, size, count);
+	free(session);
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*
+ * mystdlib_bench.c
+ *
+ * Host-side check and benchmark of the ODSI mymemcpy/mymemset/mymemcmp.
+ * Each helper is first compared against libc over every small size and
+ * source/destination misalignment, then timed against the volatile byte
+ * loops it replaced and against libc on the sizes the ODSI paths use.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mystdlib.h"
+
+#define BUFFER_SIZE	8192
+#define TARGET_NS	200000000ULL
+
+/* The byte loops the helpers replaced, kept verbatim as the baseline */
+static void *byte_memcpy( void *pvDest, const void *pvSource, size_t xBytes )
+{
+volatile unsigned char *pcDest = ( volatile unsigned char * ) pvDest, *pcSource = ( volatile unsigned char * ) pvSource;
+size_t x;
+
+	if( pvDest != pvSource )
+		for( x = 0; x < xBytes; x++ )
+			pcDest[ x ] = pcSource[ x ];
+	return pvDest;
+}
+
+static void *byte_memset( void *pvDest, int iValue, size_t xBytes )
+{
+volatile unsigned char * volatile pcDest = ( volatile unsigned char * volatile ) pvDest;
+volatile size_t x;
+
+	for( x = 0; x < xBytes; x++ )
+		pcDest[ x ] = ( unsigned char ) iValue;
+	return pvDest;
+}
+
+static int byte_memcmp( const void *pvMem1, const void *pvMem2, unsigned long ulBytes )
+{
+const volatile unsigned char *pucMem1 = pvMem1, *pucMem2 = pvMem2;
+register unsigned long x;
+
+	for( x = 0; x < ulBytes; x++ )
+	{
+		if( pucMem1[ x ] != pucMem2[ x ] )
+		{
+			break;
+		}
+	}
+	return ulBytes - x;
+}
+
+/* Called through pointers so the compiler can not inline libc builtins */
+static void *( *volatile libc_memcpy )( void *, const void *, size_t ) = memcpy;
+static void *( *volatile libc_memset )( void *, int, size_t ) = memset;
+static int ( *volatile libc_memcmp )( const void *, const void *, size_t ) = memcmp;
+
+static unsigned char src[ BUFFER_SIZE ], dst[ BUFFER_SIZE ], ref[ BUFFER_SIZE ];
+
+static void fill( unsigned char *buffer, size_t size, unsigned seed )
+{
+size_t i;
+
+	for( i = 0; i < size; i++ )
+		buffer[ i ] = ( unsigned char ) ( seed + i * 7 );
+}
+
+static int check( void )
+{
+size_t size, so, doff, diff;
+int errors = 0;
+
+	for( size = 0; size < 256; size++ )
+	{
+		for( so = 0; so < 8; so++ )
+		{
+			for( doff = 0; doff < 8; doff++ )
+			{
+				fill( src, sizeof( src ), ( unsigned ) size );
+				fill( dst, sizeof( dst ), 0x5a );
+				memcpy( ref, dst, sizeof( ref ) );
+				memcpy( ref + doff, src + so, size );
+				if( mymemcpy( dst + doff, src + so, size ) != dst + doff || memcmp( dst, ref, sizeof( dst ) ) )
+				{
+					printf( "mymemcpy size %zu src+%zu dst+%zu: FAIL\n", size, so, doff );
+					errors++;
+				}
+
+				fill( dst, sizeof( dst ), 0x5a );
+				memcpy( ref, dst, sizeof( ref ) );
+				memset( ref + doff, 0xa5, size );
+				if( mymemset( dst + doff, 0xa5, size ) != dst + doff || memcmp( dst, ref, sizeof( dst ) ) )
+				{
+					printf( "mymemset size %zu dst+%zu: FAIL\n", size, doff );
+					errors++;
+				}
+
+				/* mymemcmp returns the bytes left from the first difference */
+				memcpy( dst + doff, src + so, size );
+				if( mymemcmp( dst + doff, src + so, size ) != 0 )
+				{
+					printf( "mymemcmp size %zu equal: FAIL\n", size );
+					errors++;
+				}
+				for( diff = 0; diff < size; diff += 1 + diff / 4 )
+				{
+					dst[ doff + diff ] ^= 0xff;
+					if( mymemcmp( dst + doff, src + so, size ) != ( int ) ( size - diff ) ||
+					    byte_memcmp( dst + doff, src + so, size ) != ( int ) ( size - diff ) )
+					{
+						printf( "mymemcmp size %zu diff at %zu: FAIL\n", size, diff );
+						errors++;
+					}
+					dst[ doff + diff ] ^= 0xff;
+				}
+			}
+		}
+	}
+	return errors;
+}
+
+static unsigned long long now( void )
+{
+struct timespec ts;
+
+	clock_gettime( CLOCK_MONOTONIC, &ts );
+	return ( unsigned long long ) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+enum { OP_MEMCPY, OP_MEMSET, OP_MEMCMP };
+
+static double run( int op, int impl, size_t size, size_t align )
+{
+unsigned long long start, elapsed, iterations = 0, i, batch = 64;
+volatile int sink = 0;
+
+	memcpy( dst, src, sizeof( dst ) );
+	start = now();
+	do
+	{
+		for( i = 0; i < batch; i++ )
+		{
+			switch( op * 3 + impl )
+			{
+			case 0: byte_memcpy( dst + align, src, size ); break;
+			case 1: mymemcpy( dst + align, src, size ); break;
+			case 2: libc_memcpy( dst + align, src, size ); break;
+			case 3: byte_memset( dst + align, ( int ) i, size ); break;
+			case 4: mymemset( dst + align, ( int ) i, size ); break;
+			case 5: libc_memset( dst + align, ( int ) i, size ); break;
+			case 6: sink += byte_memcmp( dst, src, size ); break;
+			case 7: sink += mymemcmp( dst, src, size ); break;
+			case 8: sink += libc_memcmp( dst, src, size ); break;
+			}
+		}
+		iterations += batch;
+		elapsed = now() - start;
+	} while( elapsed < TARGET_NS / 9 );
+
+	( void ) sink;
+	return ( double ) elapsed / ( double ) iterations;
+}
+
+int main( void )
+{
+static const char *names[] = { "memcpy", "memset", "memcmp" };
+static const size_t sizes[] = { 8, 16, 64, 256, 600, 1500, 4096 };
+size_t s, align;
+int op, errors;
+
+	fill( src, sizeof( src ), 1 );
+	errors = check();
+	printf( "correctness: %s\n\n", errors ? "FAIL" : "ok" );
+
+	printf( "%-7s %6s %5s %12s %12s %12s %8s\n", "op", "bytes", "align", "byte ns", "my ns", "libc ns", "speedup" );
+	for( op = OP_MEMCPY; op <= OP_MEMCMP; op++ )
+	{
+		for( s = 0; s < sizeof( sizes ) / sizeof( sizes[ 0 ] ); s++ )
+		{
+			for( align = 0; align < 2; align++ )
+			{
+				double byte = run( op, 0, sizes[ s ], align );
+				double my = run( op, 1, sizes[ s ], align );
+				double libc = run( op, 2, sizes[ s ], align );
+
+				printf( "%-7s %6zu %5zu %12.1f %12.1f %12.1f %7.1fx\n", names[ op ], sizes[ s ], align,
+				        byte, my, libc, byte / my );
+			}
+		}
+	}
+
+	return errors ? EXIT_FAILURE : EXIT_SUCCESS;
+}
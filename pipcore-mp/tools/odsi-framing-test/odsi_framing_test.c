@@ -0,0 +1,398 @@
+/*
+ * odsi_framing_test.c
+ *
+ * Host-side check of the NetworkMngr ODSI framing and of the receive FIFO.
+ * Each ESP8266 link gets a stream of "ODSI" <size> <payload> frames mixed
+ * with garbage: stray bytes, truncated magics, headers of size 0 or too big
+ * for the FIFO. The streams are handed to esp8266_get_tcp_payload() the way
+ * +IPD segments arrive, links interleaved, in random segment sizes and with
+ * short UART reads, so frames are split across segments and the FIFOs wrap.
+ * After each segment the frames are taken in random batch sizes through
+ * ext_receive_frames()/ext_release_frames(), and must be the frames sent, in
+ * order, on their link, with their payload intact.
+ * fifo_linearize() and the FIFO spans are also checked on their own, for
+ * every read index.
+ *
+ * usage: odsi_framing_test
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <esp8266.h>
+#include <FIFO.h>
+#include "NWManager_Interface.h"
+
+#define SEEDS					500
+#define FRAMES					200		// per link and seed
+#define MAX_FRAME				1500	// random frames, the largest one is checked apart
+#define MAX_SEGMENT				1024
+#define MAX_BATCH				8
+#define STREAM_SIZE				(FRAMES * (MAX_FRAME + 64))
+#define LARGEST_FRAME			(FIFO_BUFFER_SIZE - ODSI_FRAME_HEADER_SIZE)
+
+int esp8266_get_tcp_payload(uint32_t link, unsigned int payload_size);
+void esp8266_link_closed(uint32_t link);
+
+typedef struct
+{
+	uint32_t size;
+	uint32_t seed;
+} frame_t;
+
+typedef struct
+{
+	char *data;
+	uint32_t size;
+	uint32_t fed;
+	frame_t frames[FRAMES + 1];
+	uint32_t count;
+	uint32_t received;
+} stream_t;
+
+static stream_t streams[ESP8266_MAX_LINKS];
+static unsigned long rotations;
+
+/* The UART: the bytes of the segment being read */
+static const char *uart_data;
+static unsigned long uart_size;
+
+unsigned long vGalileo_UART0_read(char *buf, unsigned long size)
+{
+	// the DMA ring hands out what has arrived so far
+	if(size > 1)
+	{
+		size = rand() % size + 1;
+	}
+	if(size > uart_size)
+	{
+		size = uart_size;
+	}
+	memcpy(buf, uart_data, size);
+	uart_data += size;
+	uart_size -= size;
+	return size;
+}
+
+/* The rest of the ESP8266 side is never reached by the receive path */
+unsigned long vGalileo_UART0_read_line(char *buf, unsigned long max_size) { return 0; }
+void vGalileo_UART0_write(const char *buf, unsigned long size) { }
+int vGalileo_UART0_is_data_available() { return 0; }
+void vGalileo_UART0_flush_DMA_rcv_buffer() { }
+void vInitializeGalileo_client_SerialPort() { }
+void esp8266_hard_reset() { }
+int esp8266_response_contains(const char *response, const char *contain) { return 0; }
+int esp8266_send_tcp_header(int link, int length_int) { return 0; }
+void vTaskDelay(TickType_t ticks) { }
+void vTaskDelay_ms(uint32_t ms) { }
+void debug1(const char *format, ...) { }
+
+char *__real_fifo_linearize(fifo_t *fifo);
+
+char *__wrap_fifo_linearize(fifo_t *fifo)
+{
+	if(fifo->index + fifo->length > fifo_get_size(fifo))
+	{
+		rotations++;
+	}
+	return __real_fifo_linearize(fifo);
+}
+
+static void fail(const char *format, ...)
+{
+	va_list args;
+
+	va_start(args, format);
+	vfprintf(stderr, format, args);
+	va_end(args);
+	exit(1);
+}
+
+static uint8_t payload_byte(uint32_t seed, uint32_t i)
+{
+	return (uint8_t) ((seed * 2654435761u + i * 40503u) >> 13);
+}
+
+/* Garbage never holds an 'O', so it can't hide a frame header */
+static char garbage_byte(void)
+{
+	char c;
+
+	do
+	{
+		c = (char) rand();
+	}
+	while(c == 'O');
+	return c;
+}
+
+static void put(stream_t *stream, const void *data, uint32_t size)
+{
+	memcpy(&stream->data[stream->size], data, size);
+	stream->size += size;
+}
+
+static void put_header(stream_t *stream, uint32_t size)
+{
+	put(stream, ODSI_FRAME_MAGIC, 4);
+	put(stream, &size, sizeof(size));
+}
+
+static void put_garbage(stream_t *stream)
+{
+	static const uint32_t bad_sizes[] = { 0, LARGEST_FRAME + 1, 0x10000, 0xFFFFFFFF };
+	uint32_t i, count = rand() % 24;
+	char c;
+
+	switch(rand() % 8)
+	{
+		case 0:
+			put(stream, "ODS", 1 + rand() % 3);
+			break;
+		case 1:
+			put_header(stream, bad_sizes[rand() % 4]);
+			break;
+		default:
+			break;
+	}
+	for(i = 0; i < count; i++)
+	{
+		c = garbage_byte();
+		put(stream, &c, 1);
+	}
+}
+
+static void put_frame(stream_t *stream, uint32_t size, uint32_t seed)
+{
+	uint32_t i;
+
+	put_header(stream, size);
+	for(i = 0; i < size; i++)
+	{
+		stream->data[stream->size++] = payload_byte(seed, i);
+	}
+	stream->frames[stream->count].size = size;
+	stream->frames[stream->count].seed = seed;
+	stream->count++;
+}
+
+static void reset_links(void)
+{
+	uint32_t link;
+
+	for(link = 0; link < ESP8266_MAX_LINKS; link++)
+	{
+		esp8266_link_closed(link);
+		streams[link].size = streams[link].fed = 0;
+		streams[link].count = streams[link].received = 0;
+	}
+}
+
+/* Takes every complete frame, max_batch at most per call */
+static void receive(uint32_t seed, uint32_t max_batch)
+{
+	ext_frame_t frames[MAX_BATCH];
+	stream_t *stream;
+	frame_t *expected;
+	uint32_t count, i, j;
+
+	do
+	{
+		count = ext_receive_frames(NULL, frames, rand() % max_batch + 1);
+		for(i = 0; i < count; i++)
+		{
+			if(frames[i].link >= ESP8266_MAX_LINKS)
+			{
+				fail("seed %u: frame on link %u\n", seed, frames[i].link);
+			}
+			stream = &streams[frames[i].link];
+			if(stream->received == stream->count)
+			{
+				fail("seed %u link %u: frame of %u bytes, none was sent\n", seed, frames[i].link, frames[i].size);
+			}
+			expected = &stream->frames[stream->received++];
+			if(frames[i].size != expected->size)
+			{
+				fail("seed %u link %u: frame %u has %u bytes, expected %u\n",
+					 seed, frames[i].link, stream->received - 1, frames[i].size, expected->size);
+			}
+			for(j = 0; j < expected->size; j++)
+			{
+				if((uint8_t) frames[i].data[j] != payload_byte(expected->seed, j))
+				{
+					fail("seed %u link %u: frame %u differs at byte %u\n", seed, frames[i].link, stream->received - 1, j);
+				}
+			}
+		}
+		ext_release_frames(NULL);
+	}
+	while(count > 0);
+}
+
+/* Feeds one segment of the link's stream, that stops at end at the latest */
+static void feed(stream_t *stream, uint32_t link, uint32_t max_segment, uint32_t end)
+{
+	uint32_t size = rand() % max_segment + 1;
+
+	if(size > end - stream->fed)
+	{
+		size = end - stream->fed;
+	}
+	uart_data = &stream->data[stream->fed];
+	uart_size = size;
+	if(esp8266_get_tcp_payload(link, size) != (int) size)
+	{
+		fail("link %u: segment of %u bytes not read\n", link, size);
+	}
+	stream->fed += size;
+}
+
+static void check_received(uint32_t seed)
+{
+	uint32_t link;
+
+	for(link = 0; link < ESP8266_MAX_LINKS; link++)
+	{
+		if(streams[link].received != streams[link].count)
+		{
+			fail("seed %u link %u: %u frames sent, %u received\n", seed, link, streams[link].count, streams[link].received);
+		}
+	}
+}
+
+static void check_streams(void)
+{
+	uint32_t seed, link, i, pending, frames = 0;
+
+	for(seed = 0; seed < SEEDS; seed++)
+	{
+		srand(seed);
+		reset_links();
+		for(link = 0; link < ESP8266_MAX_LINKS; link++)
+		{
+			for(i = 0; i < FRAMES; i++)
+			{
+				put_garbage(&streams[link]);
+				put_frame(&streams[link], rand() % MAX_FRAME + 1, rand());
+			}
+			// an incomplete magic left at the end must not give a frame
+			put(&streams[link], "ODSI", rand() % 4);
+			frames += FRAMES;
+		}
+
+		do
+		{
+			pending = 0;
+			for(link = 0; link < ESP8266_MAX_LINKS; link++)
+			{
+				pending += streams[link].size - streams[link].fed;
+			}
+			link = rand() % ESP8266_MAX_LINKS;
+			if(streams[link].fed < streams[link].size)
+			{
+				feed(&streams[link], link, MAX_SEGMENT, streams[link].size);
+				receive(seed, MAX_BATCH);
+			}
+		}
+		while(pending > 0);
+
+		check_received(seed);
+	}
+	if(rotations == 0)
+	{
+		fail("streams: the fifos never wrapped\n");
+	}
+	printf("streams: ok, %d seeds, %u frames, %lu wrapped fifos linearized\n", SEEDS, frames, rotations);
+}
+
+/*
+ * A frame filling the whole fifo, then one too big for it.
+ * Nothing can be received while the largest frame is in, so the segments
+ * stop at its end: what follows would not fit and be dropped.
+ */
+static void check_largest(void)
+{
+	stream_t *stream = &streams[0];
+	uint32_t seed, end;
+
+	for(seed = 0; seed < 64; seed++)
+	{
+		srand(seed);
+		reset_links();
+		// leave the read index anywhere
+		put_frame(stream, rand() % MAX_FRAME + 1, seed);
+		put_frame(stream, LARGEST_FRAME, seed + 1);
+		end = stream->size;
+		put_header(stream, LARGEST_FRAME + 1);
+		put_garbage(stream);
+		put_frame(stream, 1, seed + 2);
+		while(stream->fed < stream->size)
+		{
+			feed(stream, 0, MAX_SEGMENT, stream->fed < end ? end : stream->size);
+			receive(seed, 1);
+		}
+		check_received(seed);
+	}
+	printf("largest: ok, %u byte frames go through, %u byte ones are skipped\n", LARGEST_FRAME, LARGEST_FRAME + 1);
+}
+
+/* Content and spans of the fifo for every read index */
+static void check_fifo(void)
+{
+	static fifo_t fifo;
+	static char pattern[FIFO_BUFFER_SIZE], pulled[FIFO_BUFFER_SIZE];
+	uint32_t index, length, i, span_size;
+	char *span, *data;
+
+	for(i = 0; i < FIFO_BUFFER_SIZE; i++)
+	{
+		pattern[i] = (char) payload_byte(7, i);
+	}
+	for(index = 0; index < FIFO_BUFFER_SIZE; index++)
+	{
+		length = rand() % (FIFO_BUFFER_SIZE + 1);
+		fifo_init(&fifo);
+		fifo_push(&fifo, pattern, index);
+		fifo_drop(&fifo, index);
+		if(!fifo_push(&fifo, pattern, length))
+		{
+			fail("fifo: push of %u bytes at %u refused\n", length, index);
+		}
+
+		span_size = fifo_write_span(&fifo, &span);
+		if(span_size > FIFO_BUFFER_SIZE - length
+		   || span + span_size > fifo.buffer + FIFO_BUFFER_SIZE
+		   || (span_size == 0 && length < FIFO_BUFFER_SIZE))
+		{
+			fail("fifo: span of %u bytes at %u, index %u length %u\n", span_size, (uint32_t) (span - fifo.buffer), index, length);
+		}
+
+		data = __real_fifo_linearize(&fifo);
+		if(fifo_get_length(&fifo) != length || data + length > fifo.buffer + FIFO_BUFFER_SIZE
+		   || memcmp(data, pattern, length) != 0)
+		{
+			fail("fifo: linearized content differs, index %u length %u\n", index, length);
+		}
+		if(fifo_pull(&fifo, pulled, FIFO_BUFFER_SIZE) != length || memcmp(pulled, pattern, length) != 0)
+		{
+			fail("fifo: pulled content differs, index %u length %u\n", index, length);
+		}
+	}
+	printf("fifo: ok, every read index\n");
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t link;
+
+	for(link = 0; link < ESP8266_MAX_LINKS; link++)
+	{
+		streams[link].data = malloc(STREAM_SIZE);
+	}
+
+	check_fifo();
+	check_streams();
+	check_largest();
+	return 0;
+}
@@ -0,0 +1,15 @@
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+/* Host stand-in for the FreeRTOS headers manageNW_Simple.c includes */
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+
+#define pdMS_TO_TICKS(ms)		((TickType_t) (ms))
+
+void vTaskDelay(TickType_t ticks);
+void vTaskDelay_ms(uint32_t ms);
+
+#endif
@@ -0,0 +1 @@
+/* Host stand-in: manageNW_Simple.c uses nothing from libpip */
@@ -0,0 +1,601 @@
+/*
+ * shared_ring_test.c
+ *
+ * Host-side check of the shared-ring channels of the FreeRTOS partitions.
+ * The real sharedChannel.c is built against stub/pip, and this file plays
+ * the root behind Pip_Notify, the way partitionServices.c serves
+ * channelRingOpen, channelRingWait and channelRingNotify:
+ *  - each ring page is a page of its own memfd mapping, seen contiguous by
+ *    the endpoint and one page at a time, between guard pages, by the root;
+ *  - the slot layout never straddles a page and stays in the ring;
+ *  - random interleavings of non-blocking sends and receives deliver every
+ *    item in order, with the doorbells alone: once the producer stops, the
+ *    consumer drains everything it sent;
+ *  - a burst costs no doorbell to send and a single one to receive;
+ *  - a producer and a consumer thread blocking on full and empty rings never
+ *    lose a wakeup;
+ *  - hostile indexes written in the rings keep the relay in bounds.
+ *
+ * usage: shared_ring_test
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/mman.h>
+#include "pip/api.h"
+#include "pip/compat.h"
+#include "partitionServices.h"
+#include "sharedChannel.h"
+
+#define PAGE					SHARED_CHANNEL_PAGE
+#define SEEDS					2000
+#define STEPS					2000
+#define THREAD_ITEMS			200000
+#define THREAD_TIMEOUT			60		// seconds before a lost wakeup is assumed
+
+#define PRODUCER				SHARED_CHANNEL_PRODUCER
+#define CONSUMER				SHARED_CHANNEL_CONSUMER
+
+/* What the root keeps for each channel, as in partitionServices.c */
+typedef struct
+{
+	sharedChannelView_t view;
+	uint32_t pages;
+	int fd[2];
+	uint8_t *vaddr[2];
+	int itemsAvailable;
+	int spaceAvailable;
+} channel_t;
+
+static channel_t channels[SHARED_CHANNEL_MAX];
+static pthread_mutex_t root = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t given = PTHREAD_COND_INITIALIZER;
+static __thread int caller;
+static unsigned long notifies, waits;
+
+static void fail(const char *what)
+{
+	fprintf(stderr, "%s\n", what);
+	exit(1);
+}
+
+void * Pip_AllocPage(void)
+{
+	void *page = mmap(NULL, PAGE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+	return page == MAP_FAILED ? NULL : page;
+}
+
+void Pip_FreePage(void * page)
+{
+	munmap(page, PAGE);
+}
+
+/* An address range the endpoint picks for its ring, below 4GB */
+static uint32_t reserve(uint32_t pages)
+{
+	void *range = mmap(NULL, pages * PAGE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+	if(range == MAP_FAILED)
+	{
+		fail("reserve: mmap failed");
+	}
+	return (uint32_t) (uintptr_t) range;
+}
+
+/* Maps the ring pages of one side: contiguous at vaddr for the endpoint, each
+ * page alone between two guard pages for the root, last page first */
+static void map_side(channel_t *channel, int side, uint32_t vaddr)
+{
+	uint8_t **pages = side == PRODUCER ? channel->view.tx : channel->view.rx;
+	uint8_t *guarded;
+	int fd, i;
+
+	fd = memfd_create("ring", 0);
+	if(fd < 0 || ftruncate(fd, channel->pages * PAGE))
+	{
+		fail("map_side: memfd failed");
+	}
+	if(mmap((void *) (uintptr_t) vaddr, channel->pages * PAGE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+	{
+		fail("map_side: endpoint mapping failed");
+	}
+	for(i = channel->pages - 1; i >= 0; i--)
+	{
+		guarded = mmap(NULL, 3 * PAGE, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(guarded == MAP_FAILED
+		   || mmap(guarded + PAGE, PAGE, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED, fd, i * PAGE) == MAP_FAILED)
+		{
+			fail("map_side: root mapping failed");
+		}
+		pages[i] = guarded + PAGE;
+	}
+	channel->fd[side] = fd;
+	channel->vaddr[side] = (uint8_t *) (uintptr_t) vaddr;
+}
+
+static void unmap_side(channel_t *channel, int side)
+{
+	uint8_t **pages = side == PRODUCER ? channel->view.tx : channel->view.rx;
+	uint32_t i;
+
+	if(!pages[0])
+	{
+		return;
+	}
+	for(i = 0; i < channel->pages; i++)
+	{
+		munmap(pages[i] - PAGE, 3 * PAGE);
+	}
+	munmap(channel->vaddr[side], channel->pages * PAGE);
+	close(channel->fd[side]);
+}
+
+static void close_channel(uint32_t id)
+{
+	unmap_side(&channels[id], PRODUCER);
+	unmap_side(&channels[id], CONSUMER);
+	memset(&channels[id], 0, sizeof(channel_t));
+}
+
+/* Binary semaphores of the root, given and taken under the root lock */
+static void give(int *semaphore)
+{
+	*semaphore = 1;
+	pthread_cond_broadcast(&given);
+}
+
+static int take(int *semaphore, uint32_t ticks)
+{
+	struct timespec until;
+
+	clock_gettime(CLOCK_REALTIME, &until);
+	until.tv_nsec += (ticks % 1000) * 1000000;
+	until.tv_sec += ticks / 1000 + until.tv_nsec / 1000000000;
+	until.tv_nsec %= 1000000000;
+	while(!*semaphore)
+	{
+		if(ticks == SHARED_CHANNEL_MAX_WAIT)
+		{
+			pthread_cond_wait(&given, &root);
+		}
+		else if(pthread_cond_timedwait(&given, &root, &until) == ETIMEDOUT)
+		{
+			return 0;
+		}
+	}
+	*semaphore = 0;
+	return 1;
+}
+
+static void open_service(xChannelOpenParameters *call)
+{
+	channel_t *channel;
+	uint32_t pages;
+
+	call->returnCall = 0;
+	if(call->id >= SHARED_CHANNEL_MAX || call->role > CONSUMER || !call->itemSize || call->itemSize > PAGE
+	   || !call->length || (call->length & (call->length - 1))
+	   || call->length > SHARED_CHANNEL_MAX_PAGES * PAGE / SHARED_CHANNEL_CACHE_LINE)
+	{
+		return;
+	}
+	channel = &channels[call->id];
+	pages = sharedRingPages(call->itemSize, call->length);
+	if(channel->pages && (channel->view.itemSize != call->itemSize || channel->view.length != call->length))
+	{
+		return;
+	}
+	if((call->role == PRODUCER ? channel->view.tx : channel->view.rx)[0] || pages > SHARED_CHANNEL_MAX_PAGES)
+	{
+		return;
+	}
+	if(!channel->pages)
+	{
+		channel->view.itemSize = call->itemSize;
+		channel->view.slotSize = sharedRingSlotSize(call->itemSize);
+		channel->view.length = call->length;
+		channel->pages = pages;
+	}
+	map_side(channel, call->role, call->vaddr);
+	sharedRingInit((sharedRing_t *) (call->role == PRODUCER ? channel->view.tx : channel->view.rx)[0],
+				   call->id, call->itemSize, call->length);
+	call->returnCall = call->vaddr;
+}
+
+static void wake(channel_t *channel)
+{
+	if(!sharedChannelRelay(&channel->view))
+	{
+		return;
+	}
+	if(((sharedRing_t *) channel->view.rx[0])->consumerWaiting)
+	{
+		give(&channel->itemsAvailable);
+	}
+	if(((sharedRing_t *) channel->view.tx[0])->producerWaiting)
+	{
+		give(&channel->spaceAvailable);
+	}
+}
+
+static void wait_service(uint32_t data2)
+{
+	channel_t *channel = &channels[data2 & 0xFF];
+	sharedRing_t *tx = (sharedRing_t *) channel->view.tx[0];
+	sharedRing_t *rx = (sharedRing_t *) channel->view.rx[0];
+	uint32_t ticks = data2 >> 8;
+
+	waits++;
+	if(rx && caller == CONSUMER)
+	{
+		if(tx)
+		{
+			tx->consumerWaiting = 1;
+		}
+		__sync_synchronize();
+		wake(channel);
+		while(!sharedRingCount(rx))
+		{
+			if(!take(&channel->itemsAvailable, ticks))
+			{
+				break;
+			}
+			wake(channel);
+		}
+		if(tx)
+		{
+			tx->consumerWaiting = 0;
+		}
+	}
+	else if(tx && caller == PRODUCER)
+	{
+		wake(channel);
+		while(sharedRingCount(tx) >= channel->view.length)
+		{
+			if(!take(&channel->spaceAvailable, ticks))
+			{
+				break;
+			}
+			wake(channel);
+		}
+	}
+}
+
+static void notify_service(uint32_t id)
+{
+	notifies++;
+	wake(&channels[id]);
+}
+
+uint32_t Pip_Notify(uint32_t destination, uint32_t int_no, uint32_t data1, uint32_t data2)
+{
+	pthread_mutex_lock(&root);
+	switch(data1)
+	{
+		case channelRingOpen:
+			open_service((xChannelOpenParameters *) (uintptr_t) data2);
+			break;
+		case channelRingWait:
+			wait_service(data2);
+			break;
+		case channelRingNotify:
+			notify_service(data2);
+			break;
+		default:
+			fail("Pip_Notify: unexpected service");
+	}
+	pthread_mutex_unlock(&root);
+	return 0;
+}
+
+/* Item contents, so a slot copied from the wrong place is noticed */
+static void fill(uint8_t *item, uint32_t size, uint32_t sequence)
+{
+	uint32_t i;
+
+	for(i = 0; i < size; i++)
+	{
+		item[i] = (uint8_t) (sequence * 31 + i);
+	}
+}
+
+static int same(const uint8_t *item, uint32_t size, uint32_t sequence)
+{
+	uint32_t i;
+
+	for(i = 0; i < size; i++)
+	{
+		if(item[i] != (uint8_t) (sequence * 31 + i))
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+static void open_pair(uint32_t id, uint32_t itemSize, uint32_t length, sharedRing_t **tx, sharedRing_t **rx)
+{
+	uint32_t pages = sharedRingPages(itemSize, length);
+
+	caller = PRODUCER;
+	*tx = xProtectedChannelOpen(id, PRODUCER, itemSize, length, reserve(pages));
+	caller = CONSUMER;
+	*rx = xProtectedChannelOpen(id, CONSUMER, itemSize, length, reserve(pages));
+	if(!*tx || !*rx)
+	{
+		fail("open: channel refused");
+	}
+}
+
+static int check_geometry(void)
+{
+	static const uint32_t sizes[] = { 1, 4, 60, 64, 65, 100, 200, 1000, 2048, 2049, 4096 };
+	uint8_t used[SHARED_CHANNEL_MAX_PAGES][PAGE / SHARED_CHANNEL_CACHE_LINE];
+	uint32_t s, length, pages, slotSize, index, page, offset;
+	int checked = 0;
+
+	for(s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++)
+	{
+		slotSize = sharedRingSlotSize(sizes[s]);
+		for(length = 1; length <= 1024; length <<= 1)
+		{
+			pages = sharedRingPages(sizes[s], length);
+			if(pages > SHARED_CHANNEL_MAX_PAGES)
+			{
+				if(xProtectedChannelOpen(0, PRODUCER, sizes[s], length, reserve(1)))
+				{
+					fprintf(stderr, "geometry: item %u length %u needs %u pages and was opened\n", sizes[s], length, pages);
+					return 1;
+				}
+				continue;
+			}
+			memset(used, 0, sizeof(used));
+			for(index = 0; index < 2 * length; index++)
+			{
+				page = sharedRingSlotPage(index, slotSize, length);
+				offset = sharedRingSlotOffset(index, slotSize, length);
+				if(page < 1 || page >= pages || offset % SHARED_CHANNEL_CACHE_LINE || offset + slotSize > PAGE
+				   || (index < length && used[page][offset / SHARED_CHANNEL_CACHE_LINE]++))
+				{
+					fprintf(stderr, "geometry: item %u length %u slot %u at page %u offset %u\n", sizes[s], length, index, page, offset);
+					return 1;
+				}
+			}
+			checked++;
+		}
+	}
+	if(xProtectedChannelOpen(0, PRODUCER, 4, 3, reserve(2)) || xProtectedChannelOpen(0, PRODUCER, PAGE + 1, 1, reserve(3)))
+	{
+		fprintf(stderr, "geometry: a length of 3 or an item over a page was opened\n");
+		return 1;
+	}
+	printf("geometry: ok, %d layouts\n", checked);
+	return 0;
+}
+
+/* Random non-blocking sends and receives, then the consumer alone drains */
+static int check_interleave(void)
+{
+	static const uint32_t sizes[] = { 4, 64, 100, 1000, 4096 };
+	uint8_t item[PAGE];
+	sharedRing_t *tx, *rx;
+	uint32_t seed, step, itemSize, length, sent, received, burst;
+	unsigned long doorbells = 0;
+
+	for(seed = 0; seed < SEEDS; seed++)
+	{
+		srand(seed);
+		itemSize = sizes[rand() % (sizeof(sizes) / sizeof(sizes[0]))];
+		do
+		{
+			length = 1 << (rand() % 7);
+		}
+		while(sharedRingPages(itemSize, length) > SHARED_CHANNEL_MAX_PAGES);
+		open_pair(seed % SHARED_CHANNEL_MAX, itemSize, length, &tx, &rx);
+		notifies = 0;
+		sent = received = 0;
+
+		for(step = 0; step < STEPS; step++)
+		{
+			burst = rand() % (3 * length) + 1;
+			if(rand() & 1)
+			{
+				caller = PRODUCER;
+				while(burst--)
+				{
+					fill(item, itemSize, sent);
+					if(!xProtectedChannelSend(tx, item, 0))
+					{
+						break;
+					}
+					sent++;
+				}
+			}
+			else
+			{
+				caller = CONSUMER;
+				while(burst-- && xProtectedChannelReceive(rx, item, 0))
+				{
+					if(!same(item, itemSize, received++))
+					{
+						fprintf(stderr, "interleave seed %u: item %u is wrong\n", seed, received - 1);
+						return 1;
+					}
+				}
+			}
+		}
+
+		caller = CONSUMER;
+		while(xProtectedChannelReceive(rx, item, 0))
+		{
+			if(!same(item, itemSize, received++))
+			{
+				fprintf(stderr, "interleave seed %u: item %u is wrong\n", seed, received - 1);
+				return 1;
+			}
+		}
+		if(received != sent)
+		{
+			fprintf(stderr, "interleave seed %u: %u items sent, %u received, %u left in the rings\n",
+					seed, sent, received, sharedRingCount(tx) + sharedRingCount(rx));
+			return 1;
+		}
+		doorbells += notifies;
+		close_channel(seed % SHARED_CHANNEL_MAX);
+	}
+	printf("interleave: ok, %d seeds of %d steps, %lu doorbells\n", SEEDS, STEPS, doorbells);
+	return 0;
+}
+
+/* A burst costs no doorbell to send and a single one to receive */
+static int check_burst(void)
+{
+	uint8_t item[64];
+	sharedRing_t *tx, *rx;
+	uint32_t i, round;
+
+	open_pair(0, sizeof(item), 64, &tx, &rx);
+	for(round = 0; round < 4; round++)
+	{
+		notifies = 0;
+		caller = PRODUCER;
+		for(i = 0; i < 64; i++)
+		{
+			fill(item, sizeof(item), i);
+			xProtectedChannelSend(tx, item, 0);
+		}
+		if(notifies != 0)
+		{
+			fprintf(stderr, "burst: sending 64 items rang %lu doorbells\n", notifies);
+			return 1;
+		}
+		caller = CONSUMER;
+		for(i = 0; i < 64; i++)
+		{
+			if(!xProtectedChannelReceive(rx, item, 0) || !same(item, sizeof(item), i))
+			{
+				fprintf(stderr, "burst: item %u is wrong\n", i);
+				return 1;
+			}
+		}
+		if(notifies != 1)
+		{
+			fprintf(stderr, "burst: receiving 64 items rang %lu doorbells\n", notifies);
+			return 1;
+		}
+	}
+	close_channel(0);
+	printf("burst: ok, one doorbell per burst\n");
+	return 0;
+}
+
+static sharedRing_t *thread_tx, *thread_rx;
+static uint32_t thread_size;
+
+static void *producer_thread(void *unused)
+{
+	uint8_t item[PAGE];
+	uint32_t i;
+
+	caller = PRODUCER;
+	for(i = 0; i < THREAD_ITEMS; i++)
+	{
+		fill(item, thread_size, i);
+		while(!xProtectedChannelSend(thread_tx, item, SHARED_CHANNEL_MAX_WAIT))
+		{
+		}
+	}
+	return NULL;
+}
+
+static void lost_wakeup(int signal)
+{
+	static const char message[] = "threads: no progress, a wakeup was lost\n";
+	write(2, message, sizeof(message) - 1);
+	_exit(1);
+}
+
+/* Both sides block on the root, the consumer slowed down now and then */
+static int check_threads(void)
+{
+	uint8_t item[PAGE];
+	pthread_t producer;
+	uint32_t i;
+
+	thread_size = 100;
+	open_pair(1, thread_size, 16, &thread_tx, &thread_rx);
+	notifies = waits = 0;
+	signal(SIGALRM, lost_wakeup);
+	alarm(THREAD_TIMEOUT);
+	pthread_create(&producer, NULL, producer_thread, NULL);
+
+	caller = CONSUMER;
+	for(i = 0; i < THREAD_ITEMS; i++)
+	{
+		while(!xProtectedChannelReceive(thread_rx, item, SHARED_CHANNEL_MAX_WAIT))
+		{
+		}
+		if(!same(item, thread_size, i))
+		{
+			fprintf(stderr, "threads: item %u is wrong\n", i);
+			return 1;
+		}
+		if(i % 4096 == 0)
+		{
+			usleep(100);
+		}
+	}
+	pthread_join(producer, NULL);
+	alarm(0);
+	close_channel(1);
+	printf("threads: ok, %d items, %lu doorbells, %lu waits\n", THREAD_ITEMS, notifies, waits);
+	return 0;
+}
+
+/* Indexes are child-writable: garbage must not send the relay off its pages */
+static int check_hostile(void)
+{
+	static const uint32_t garbage[] = { 0, 1, 15, 16, 17, 0x7FFFFFFF, 0x80000000, 0xFFFFFFF0, 0xFFFFFFFF };
+	uint32_t n = sizeof(garbage) / sizeof(garbage[0]);
+	uint32_t a, b, c, moved, length = 16;
+	sharedRing_t *tx, *rx;
+
+	open_pair(2, 1000, length, &tx, &rx);
+	for(a = 0; a < n; a++)
+	{
+		for(b = 0; b < n; b++)
+		{
+			for(c = 0; c < n; c++)
+			{
+				tx->head = garbage[a];
+				tx->tail = garbage[b];
+				rx->tail = garbage[c];
+				rx->head = garbage[(a + c) % n];
+				moved = sharedChannelRelay(&channels[2].view);
+				if(moved > length)
+				{
+					fprintf(stderr, "hostile: relay moved %u items\n", moved);
+					return 1;
+				}
+			}
+		}
+	}
+	close_channel(2);
+	printf("hostile: ok, %u index combinations\n", n * n * n);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if(check_geometry() || check_burst() || check_interleave() || check_hostile() || check_threads())
+	{
+		return 1;
+	}
+	return 0;
+}
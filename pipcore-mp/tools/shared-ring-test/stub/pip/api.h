@@ -0,0 +1,10 @@
+#ifndef __API__
+#define __API__
+
+/* Host stand-in for libpip: the test plays the root behind Pip_Notify */
+
+#include <stdint.h>
+
+uint32_t Pip_Notify(uint32_t destination, uint32_t int_no, uint32_t data1, uint32_t data2);
+
+#endif
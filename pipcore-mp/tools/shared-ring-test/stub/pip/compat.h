@@ -0,0 +1,12 @@
+#ifndef __COMPAT__
+#define __COMPAT__
+
+#include <stdint.h>
+
+void * Pip_AllocPage(void);
+void Pip_FreePage(void * page);
+
+#define allocPage                           Pip_AllocPage
+#define freePage                            Pip_FreePage
+
+#endif